@@ -0,0 +1,206 @@
+#ifndef _GRAPHS_BELLMANFORD_BELLMAN_FORD_H
+#define _GRAPHS_BELLMANFORD_BELLMAN_FORD_H
+
+#include <deque>
+#include <vector>
+#include <type_traits>
+#include "../common/graph.h"
+#include "../common/stats.h"
+#include "../common/weights.h"
+
+// Strategy of bellman_ford() relaxation.
+enum class BellmanFordMode
+{
+  // Passes over all edges until a pass changes nothing.
+  passes,
+
+  // Queue of vertices whose distance changed (SPFA), only their out
+  // edges are relaxed.
+  queue,
+
+  // Queue with Small-Label-First: vertex goes to the front of the
+  // queue if its distance is less than distance of the front vertex.
+  slf,
+
+  // Queue with Large-Label-Last: vertex at the front is moved to the
+  // back while its distance is greater than the average distance of
+  // queued vertices.
+  lll,
+
+  // Both SLF and LLL.
+  slf_lll
+};
+
+// Auxiliary procedure that is used in bellman_ford() implementation
+// for passes mode.
+// Complexity: O(VE), O(E) per pass until distances settle.
+template <typename Vertex, typename Weight>
+void bellman_ford_passes(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances)
+{
+  using Traits = DistanceTraits<Weight>;
+  const int n = graph.size();
+
+  // Pass number n can change distances only if there is negative
+  // cycle.
+  for (int i = 0; i < n; ++i)
+  {
+    bool changed = false;
+    for (int a = 0; a < n; ++a)
+    {
+      if (distances[a] == Traits::infinity())
+      {
+	continue;
+      }
+      for (int e = graph.begin(a); e < graph.end(a); ++e)
+      {
+	GRAPHS_COUNT(relaxations);
+	const int b = graph.target(e);
+	const auto d = Traits::add(distances[a], graph.weight(e));
+	if (distances[b] > d)
+	{
+	  distances[b] = d;
+	  changed = true;
+	}
+      }
+    }
+
+    if (!changed)
+    {
+      return;
+    }
+  }
+
+  distances.clear();
+}
+
+// Auxiliary procedure that is used in bellman_ford() implementation
+// for queue modes. Shortest path tree without negative cycles has
+// paths of less than n edges, so path of n edges means negative cycle.
+// Complexity: O(VE) in the worst case, close to O(E) in practice.
+template <typename Vertex, typename Weight>
+void bellman_ford_queue(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances,
+  const bool slf,
+  const bool lll)
+{
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+  using Sum = std::conditional_t<
+    std::is_floating_point_v<Distance>, Distance, long long>;
+  const int n = graph.size();
+  std::vector<int> lengths(n, 0);
+  std::vector<char> queued(n, 0);
+  std::deque<int> queue;
+
+  // Sum of distances of queued vertices, used by LLL.
+  Sum sum = 0;
+
+  queue.push_back(v);
+  GRAPHS_COUNT(pushes);
+  queued[v] = 1;
+  while (!queue.empty())
+  {
+    if (lll)
+    {
+      // Some queued vertex has distance not greater than average, so
+      // rotation stops. Floating point sum picks up rounding errors and
+      // may be below every distance, so rotation is also limited to
+      // one turn of the queue.
+      const Sum size = queue.size();
+      for (std::size_t turn = 0; turn < queue.size()
+	     && static_cast<Sum>(distances[queue.front()]) * size > sum;
+	   ++turn)
+      {
+	queue.push_back(queue.front());
+	queue.pop_front();
+      }
+    }
+
+    const int a = queue.front();
+    queue.pop_front();
+    GRAPHS_COUNT(pops);
+    queued[a] = 0;
+    sum -= distances[a];
+
+    for (int e = graph.begin(a); e < graph.end(a); ++e)
+    {
+      GRAPHS_COUNT(relaxations);
+      const int b = graph.target(e);
+      const Distance d = Traits::add(distances[a], graph.weight(e));
+      if (distances[b] <= d)
+      {
+	continue;
+      }
+
+      lengths[b] = lengths[a] + 1;
+      if (lengths[b] >= n)
+      {
+	distances.clear();
+	return;
+      }
+
+      if (queued[b])
+      {
+	sum -= static_cast<Sum>(distances[b]) - d;
+	distances[b] = d;
+	continue;
+      }
+
+      distances[b] = d;
+      sum += d;
+      queued[b] = 1;
+      if (slf && !queue.empty() && d < distances[queue.front()])
+      {
+	queue.push_front(b);
+	GRAPHS_COUNT(pushes);
+      }
+      else
+      {
+	queue.push_back(b);
+	GRAPHS_COUNT(pushes);
+      }
+    }
+  }
+}
+
+// Single source shortest paths from dense vertex v of the graph.
+// Distance of vertex u is stored in distances[u], unreachable vertices
+// get DistanceTraits<Weight>::infinity(). If negative cycle is
+// reachable from v distances are cleared.
+// Complexity: O(VE).
+template <typename Vertex, typename Weight>
+void bellman_ford(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances,
+  const BellmanFordMode mode = BellmanFordMode::queue)
+{
+  // Initialize distances array.
+  distances.assign(graph.size(), DistanceTraits<Weight>::infinity());
+  distances[v] = 0;
+
+  switch (mode)
+  {
+  case BellmanFordMode::passes:
+    bellman_ford_passes(graph, distances);
+    break;
+  case BellmanFordMode::queue:
+    bellman_ford_queue(graph, v, distances, false, false);
+    break;
+  case BellmanFordMode::slf:
+    bellman_ford_queue(graph, v, distances, true, false);
+    break;
+  case BellmanFordMode::lll:
+    bellman_ford_queue(graph, v, distances, false, true);
+    break;
+  case BellmanFordMode::slf_lll:
+    bellman_ford_queue(graph, v, distances, true, true);
+    break;
+  }
+}
+
+#endif  // _GRAPHS_BELLMANFORD_BELLMAN_FORD_H
@@ -0,0 +1,252 @@
+#ifndef _GRAPHS_BELLMANFORD_NEGATIVE_CYCLE_H
+#define _GRAPHS_BELLMANFORD_NEGATIVE_CYCLE_H
+
+#include <deque>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/stats.h"
+
+// Negative cycle detection with subtree disassembly (Tarjan). It's a
+// queue-based Bellman-Ford which keeps shortest path tree explicitly
+// as a preorder thread of vertices with their depths. When distance of
+// vertex b decreases, the whole subtree of b is removed from the tree,
+// since distances of its vertices are outdated, and they are not
+// scanned until they are relabeled. If the subtree contains tail a of
+// the relaxed edge, parent links from a lead to b and together with
+// edge a->b form a negative cycle. So a cycle is reported as soon as
+// it appears in the tree instead of after V passes, and vertices with
+// outdated distances don't waste scans. Distances are
+// DistanceTraits<Weight>::Distance, see weights.h.
+template <typename Vertex, typename Weight>
+class NegativeCycleFinder
+{
+public:
+
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Edge of a cycle, ends are dense indexes.
+  using CycleEdge = BasicEdge<int, Weight>;
+
+  // Make finder for the graph.
+  explicit NegativeCycleFinder(const BasicCsrGraph<Vertex, Weight>& graph);
+
+  // Search negative cycle reachable from dense vertex v. If cycle is
+  // found, its edges (with dense vertex indexes) are stored in cycle
+  // in order of traversal and true is returned. Otherwise cycle is
+  // cleared and distances() are shortest distances from v.
+  bool find(int v, std::vector<CycleEdge>& cycle);
+
+  // Search negative cycle anywhere in the graph, as if there was a
+  // virtual source with zero weight edges to all vertices.
+  bool find(std::vector<CycleEdge>& cycle);
+
+  // Get distances of the last search.
+  const std::vector<Distance>& distances() const;
+
+private:
+
+  // Initialize tree and queue with the given sources.
+  void reset(const std::vector<int>& sources);
+
+  // Run the search over the queue.
+  bool run(std::vector<CycleEdge>& cycle);
+
+  // Remove subtree of b from the tree. It returns false if tail a is
+  // in the subtree.
+  bool disassemble(int b, int a);
+
+  // Collect edges of the cycle closed by edge e from a to b.
+  void extract(int a, int e, int b, std::vector<CycleEdge>& cycle) const;
+
+  const BasicCsrGraph<Vertex, Weight>& graph_;
+
+  // Index of virtual root of the tree.
+  const int root_;
+
+  // Tentative distances.
+  std::vector<Distance> distances_;
+
+  // Parent of vertex in the tree.
+  std::vector<int> parent_;
+
+  // Position of edge from parent in the CSR arrays.
+  std::vector<int> edge_;
+
+  // Depth of vertex in the tree, 0 if vertex is not in the tree.
+  std::vector<int> depth_;
+
+  // Preorder thread of the tree, a circular list through the root.
+  std::vector<int> next_;
+  std::vector<int> prev_;
+
+  // Vertices to scan.
+  std::deque<int> queue_;
+  std::vector<char> queued_;
+};
+
+template <typename Vertex, typename Weight>
+inline NegativeCycleFinder<Vertex, Weight>::NegativeCycleFinder(
+  const BasicCsrGraph<Vertex, Weight>& graph)
+  : graph_(graph), root_(graph.size())
+{
+}
+
+template <typename Vertex, typename Weight>
+inline const std::vector<typename DistanceTraits<Weight>::Distance>&
+NegativeCycleFinder<Vertex, Weight>::distances() const
+{
+  return distances_;
+}
+
+template <typename Vertex, typename Weight>
+inline void NegativeCycleFinder<Vertex, Weight>::reset(
+  const std::vector<int>& sources)
+{
+  const int n = graph_.size();
+  distances_.assign(n, Traits::infinity());
+  parent_.assign(n + 1, -1);
+  edge_.assign(n + 1, -1);
+  depth_.assign(n + 1, 0);
+  next_.assign(n + 1, root_);
+  prev_.assign(n + 1, root_);
+  queued_.assign(n, 0);
+  queue_.clear();
+
+  // Sources are children of the virtual root.
+  int last = root_;
+  for (const int v: sources)
+  {
+    distances_[v] = 0;
+    parent_[v] = root_;
+    depth_[v] = 1;
+    next_[last] = v;
+    prev_[v] = last;
+    last = v;
+    queue_.push_back(v);
+    GRAPHS_COUNT(pushes);
+    queued_[v] = 1;
+  }
+  next_[last] = root_;
+  prev_[root_] = last;
+}
+
+template <typename Vertex, typename Weight>
+inline bool NegativeCycleFinder<Vertex, Weight>::find(
+  int v, std::vector<CycleEdge>& cycle)
+{
+  reset({v});
+  return run(cycle);
+}
+
+template <typename Vertex, typename Weight>
+inline bool NegativeCycleFinder<Vertex, Weight>::find(
+  std::vector<CycleEdge>& cycle)
+{
+  std::vector<int> sources(graph_.size());
+  for (int v = 0; v < graph_.size(); ++v)
+  {
+    sources[v] = v;
+  }
+  reset(sources);
+  return run(cycle);
+}
+
+template <typename Vertex, typename Weight>
+inline bool NegativeCycleFinder<Vertex, Weight>::disassemble(int b, int a)
+{
+  // Preorder successors of b deeper than b are its subtree.
+  int x = next_[b];
+  while (x != root_ && depth_[x] > depth_[b])
+  {
+    if (x == a)
+    {
+      return false;
+    }
+    depth_[x] = 0;
+    x = next_[x];
+  }
+
+  // Unlink b and its subtree from the thread.
+  const int before = prev_[b];
+  next_[before] = x;
+  prev_[x] = before;
+  return true;
+}
+
+template <typename Vertex, typename Weight>
+inline void NegativeCycleFinder<Vertex, Weight>::extract(
+  int a,
+  int e,
+  int b,
+  std::vector<CycleEdge>& cycle) const
+{
+  cycle.clear();
+  cycle.push_back({a, b, graph_.weight(e)});
+  for (int x = a; x != b; x = parent_[x])
+  {
+    cycle.push_back({parent_[x], x, graph_.weight(edge_[x])});
+  }
+  std::reverse(cycle.begin(), cycle.end());
+}
+
+template <typename Vertex, typename Weight>
+inline bool NegativeCycleFinder<Vertex, Weight>::run(
+  std::vector<CycleEdge>& cycle)
+{
+  cycle.clear();
+  while (!queue_.empty())
+  {
+    const int a = queue_.front();
+    queue_.pop_front();
+    GRAPHS_COUNT(pops);
+    queued_[a] = 0;
+
+    // Distance of vertex outside of the tree is outdated, it will be
+    // scanned again once it's relabeled.
+    if (depth_[a] == 0)
+    {
+      continue;
+    }
+
+    for (int e = graph_.begin(a); e < graph_.end(a); ++e)
+    {
+      GRAPHS_COUNT(relaxations);
+      const int b = graph_.target(e);
+      const Distance d = Traits::add(distances_[a], graph_.weight(e));
+      if (distances_[b] <= d)
+      {
+	continue;
+      }
+
+      if (b == a || (depth_[b] != 0 && !disassemble(b, a)))
+      {
+	extract(a, e, b, cycle);
+	return true;
+      }
+
+      // Attach b to the thread right after its new parent a.
+      distances_[b] = d;
+      parent_[b] = a;
+      edge_[b] = e;
+      depth_[b] = depth_[a] + 1;
+      next_[b] = next_[a];
+      prev_[next_[a]] = b;
+      next_[a] = b;
+      prev_[b] = a;
+
+      if (!queued_[b])
+      {
+	queue_.push_back(b);
+	GRAPHS_COUNT(pushes);
+	queued_[b] = 1;
+      }
+    }
+  }
+  return false;
+}
+
+#endif  // _GRAPHS_BELLMANFORD_NEGATIVE_CYCLE_H
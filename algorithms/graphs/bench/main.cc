@@ -0,0 +1,677 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <unistd.h>
+#include "../common/graph.h"
+#include "../common/stats.h"
+#include "../common/generators.h"
+#include "../dijkstra/dijkstra.h"
+#include "../dijkstra/point_to_point.h"
+#include "../bellmanford/bellman_ford.h"
+#include "../bellmanford/negative_cycle.h"
+#include "../deltastepping/delta_stepping.h"
+#include "../multisource/multi_source.h"
+#include "../dynamic/dynamic_paths.h"
+#include "../contraction/contraction_hierarchy.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Seconds elapsed since start.
+double elapsed(Clock::time_point start)
+{
+  const std::chrono::duration<double> d = Clock::now() - start;
+  return d.count();
+}
+
+// Reset operation counters before measured run.
+void reset_counters()
+{
+#ifdef GRAPHS_STATS
+  g_stats.reset();
+#endif
+}
+
+// Print time of the run and operation counters of its engine, if they
+// are compiled in. Time and counters are divided by amount of
+// searches, so engines run from different amounts of sources compare.
+void report(const std::string& name, double time, std::size_t searches)
+{
+  std::cout << "  " << name << ": " << time / searches * 1e3
+	    << " ms per search";
+#ifdef GRAPHS_STATS
+  std::cout << ", " << g_stats.relaxations / searches
+	    << " relaxations, " << g_stats.pushes / searches << " pushes, "
+	    << g_stats.pops / searches << " pops";
+#else
+  static_cast<void>(searches);
+#endif
+  std::cout << "\n";
+}
+
+// Amount of failed checks, bench exits with non-zero status if there
+// are any.
+int g_failures = 0;
+
+// Print failed check of the engine and count it.
+void fail(const std::string& name, const char* what)
+{
+  std::cerr << name << ": " << what << "\n";
+  ++g_failures;
+}
+
+// Compare distances with expected and print mismatch of the engine.
+void check(
+  const std::string& name,
+  const std::vector<int>& distances,
+  const std::vector<int>& expected)
+{
+  if (distances != expected)
+  {
+    fail(name, "distances mismatch");
+  }
+}
+
+// Run dijkstra Search from every source and print its time and edges
+// settled per second. Distances are checked against expected.
+template <void (*Search)(const CsrGraph&, int, std::vector<int>&)>
+void run(
+  const char* name,
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected)
+{
+  std::vector<int> distances;
+  double time = 0;
+  long long settled = 0;
+  reset_counters();
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    const auto start = Clock::now();
+    Search(graph, sources[i], distances);
+    time += elapsed(start);
+
+    // Every reachable vertex is settled once and scans its edges.
+    for (int v = 0; v < graph.size(); ++v)
+    {
+      if (distances[v] != std::numeric_limits<int>::max())
+      {
+	settled += graph.end(v) - graph.begin(v);
+      }
+    }
+    check(name, distances, expected[i]);
+  }
+
+  report(name, time, sources.size());
+  std::cout << "    " << settled / time / 1e6 << " M edges/s\n";
+}
+
+// Run search(graph, s, distances) from every source on the graph with
+// 32-bit vertex ids and weights of type Weight, built from the same
+// edges, and print its time. Ids are non-negative, so dense indexes
+// are the same as in CsrGraph and distances are checked against
+// expected after conversion to int. Weights which Weight can't hold
+// exactly, such as large ones in float, skip the run.
+template <typename Weight, typename Search>
+void run_typed(
+  const char* name,
+  const std::vector<Edge>& edges,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected,
+  Search search)
+{
+  using Graph = BasicCsrGraph<std::uint32_t, Weight>;
+  using Traits = DistanceTraits<Weight>;
+  std::vector<typename Graph::EdgeType> typed;
+  typed.reserve(edges.size());
+  for (const auto& edge: edges)
+  {
+    if (static_cast<long long>(static_cast<Weight>(edge.w)) != edge.w)
+    {
+      std::cout << "  " << name << ": skipped, weights are not exact\n";
+      return;
+    }
+    typed.push_back({static_cast<std::uint32_t>(edge.a),
+	static_cast<std::uint32_t>(edge.b), static_cast<Weight>(edge.w)});
+  }
+  const Graph graph = Graph::build(typed);
+
+  std::vector<typename Traits::Distance> distances;
+  std::vector<int> converted;
+  double time = 0;
+  reset_counters();
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    const auto start = Clock::now();
+    search(graph, sources[i], distances);
+    time += elapsed(start);
+
+    // Int distances saturate, so longer paths compare as unreachable.
+    converted.clear();
+    for (const auto d: distances)
+    {
+      converted.push_back(d >= std::numeric_limits<int>::max()
+			  ? std::numeric_limits<int>::max()
+			  : static_cast<int>(d));
+    }
+    check(name, converted, expected[i]);
+  }
+  report(name, time, sources.size());
+}
+
+// Run bellman_ford in the mode from the first source and print its
+// time. Distances are checked against expected.
+void run_bellman_ford(
+  const char* name,
+  const BellmanFordMode mode,
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected)
+{
+  std::vector<int> distances;
+  reset_counters();
+  const auto start = Clock::now();
+  bellman_ford(graph, sources[0], distances, mode);
+  const double time = elapsed(start);
+
+  check(name, distances, expected[0]);
+  report(name, time, 1);
+}
+
+// Run negative cycle search from the first source and print its time.
+// Graph must have no negative cycles reachable from the source, and
+// distances are checked against expected.
+void run_negative_cycle(
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected)
+{
+  NegativeCycleFinder finder(graph);
+  std::vector<Edge> cycle;
+  reset_counters();
+  const auto start = Clock::now();
+  const bool found = finder.find(sources[0], cycle);
+  const double time = elapsed(start);
+
+  if (found)
+  {
+    fail("negative-cycle", "unexpected cycle");
+  }
+  check("negative-cycle", finder.distances(), expected[0]);
+  report("negative-cycle", time, 1);
+}
+
+// Run delta-stepping with the given delta (0 is automatic) from every
+// source and print its time. Distances are checked against expected.
+void run_delta_stepping(
+  ThreadPool& pool,
+  const int delta,
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected)
+{
+  DeltaStepping engine(graph, pool, delta);
+  std::vector<int> distances;
+  double time = 0;
+  reset_counters();
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    const auto start = Clock::now();
+    engine.run(sources[i], distances);
+    time += elapsed(start);
+    check("delta-stepping", distances, expected[i]);
+  }
+
+  report("delta-stepping (delta " + std::to_string(engine.delta()) + ", "
+	 + std::to_string(pool.size()) + " threads)", time, sources.size());
+}
+
+// Run batch of searches from all sources on the pool and print its
+// time. Distances are checked against expected.
+void run_multi_source(
+  ThreadPool& pool,
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected)
+{
+  MultiSource engine(graph, pool);
+  std::vector<int> mismatches(pool.size(), 0);
+  reset_counters();
+  const auto start = Clock::now();
+  engine.run(sources, [&](unsigned t, int i, const auto& scratch)
+  {
+    for (int v = 0; v < graph.size(); ++v)
+    {
+      mismatches[t] += scratch.distance(v) != expected[i][v];
+    }
+  });
+  const double time = elapsed(start);
+
+  for (const int count: mismatches)
+  {
+    if (count != 0)
+    {
+      fail("multi-source", "distances mismatch");
+    }
+  }
+  report("multi-source (" + std::to_string(pool.size()) + " threads)",
+	 time, sources.size());
+}
+
+// Insert batches of random edges between vertices of the graph and
+// repair distances from the first source after every batch. Time of
+// repairs is compared with recomputation of distances from scratch on
+// the final graph, and distances are checked against it.
+void run_dynamic(
+  const CsrGraph& graph,
+  std::vector<Edge> edges,
+  const std::vector<int>& sources,
+  std::mt19937& rng)
+{
+  const int batches = 16;
+  const int batch = 64;
+  int max_weight = 1;
+  for (const auto& edge: edges)
+  {
+    max_weight = std::max(max_weight, edge.w);
+  }
+
+  DynamicPaths paths(graph, sources[0]);
+  std::vector<Edge> updates;
+  double time = 0;
+  long long changed = 0;
+  reset_counters();
+  for (int i = 0; i < batches; ++i)
+  {
+    updates.clear();
+    for (int j = 0; j < batch; ++j)
+    {
+      updates.push_back({graph.id(rng() % graph.size()),
+	  graph.id(rng() % graph.size()),
+	  static_cast<int>(1 + rng() % max_weight)});
+    }
+    edges.insert(edges.end(), updates.cbegin(), updates.cend());
+
+    const auto start = Clock::now();
+    changed += paths.update(updates);
+    time += elapsed(start);
+  }
+  report("dynamic (" + std::to_string(batch) + " edges, "
+	 + std::to_string(changed / batches) + " changed)", time, batches);
+
+  // New edges join existing vertices, so dense indexes are the same.
+  const CsrGraph final = CsrGraph::build(edges);
+  std::vector<int> expected;
+  reset_counters();
+  const auto start = Clock::now();
+  dijkstra(final, sources[0], expected);
+  report("dynamic-recompute", elapsed(start), 1);
+  check("dynamic", paths.distances(), expected);
+}
+
+// Run point to point queries from every source to random targets with
+// plain Dijkstra with early exit, bidirectional Dijkstra and A* with
+// the heuristic. Distances are checked against expected.
+template <typename H>
+void run_point_to_point(
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected,
+  H heuristic,
+  std::mt19937& rng)
+{
+  std::vector<std::pair<int, int>> queries;
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    for (int q = 0; q < 4; ++q)
+    {
+      queries.emplace_back(i, rng() % graph.size());
+    }
+  }
+
+  PathFinder finder(graph);
+  std::vector<int> path;
+  const char* names[3] = {"p2p-dijkstra", "p2p-bidirectional", "p2p-astar"};
+  for (int k = 0; k < 3; ++k)
+  {
+    double time = 0;
+    reset_counters();
+    for (const auto& [i, t]: queries)
+    {
+      const int s = sources[i];
+      const auto start = Clock::now();
+      int d = 0;
+      if (k == 0)
+      {
+	d = finder.search(s, t, path);
+      }
+      else if (k == 1)
+      {
+	d = finder.bidirectional(s, t, path);
+      }
+      else
+      {
+	d = finder.search(s, t, [&](int v) { return heuristic(v, t); }, path);
+      }
+      time += elapsed(start);
+
+      if (d != expected[i][t])
+      {
+	fail(names[k], "distances mismatch");
+      }
+    }
+    report(names[k], time, queries.size());
+  }
+}
+
+// Build contraction hierarchy of the graph and answer distance
+// queries from the sources to random targets with it. Build time is
+// reported once, query time per query.
+void run_contraction(
+  ThreadPool& pool,
+  const CsrGraph& graph,
+  const std::vector<int>& sources,
+  const std::vector<std::vector<int>>& expected,
+  std::mt19937& rng)
+{
+  ContractionHierarchy<int, int> hierarchy;
+  const auto start = Clock::now();
+  hierarchy.build(graph, pool);
+  std::cout << "  ch-build: " << elapsed(start) * 1000 << " ms, "
+	    << hierarchy.shortcuts() << " shortcuts\n";
+
+  std::vector<std::pair<int, int>> queries;
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    for (int q = 0; q < 64; ++q)
+    {
+      queries.emplace_back(i, rng() % graph.size());
+    }
+  }
+
+  ChQuery query(hierarchy);
+  double time = 0;
+  reset_counters();
+  for (const auto& [i, t]: queries)
+  {
+    const auto start = Clock::now();
+    const int d = query.distance(sources[i], t);
+    time += elapsed(start);
+
+    if (d != expected[i][t])
+    {
+      fail("ch-query", "distances mismatch");
+    }
+  }
+  report("ch-query", time, queries.size());
+}
+
+// Pick random sources among dense indexes of the graph.
+std::vector<int> pick_sources(const CsrGraph& graph, std::mt19937& rng)
+{
+  std::vector<int> sources;
+  for (int i = 0; i < 8; ++i)
+  {
+    sources.push_back(rng() % graph.size());
+  }
+  return sources;
+}
+
+// Run all engines on the graph with non-negative weights. Dijkstra
+// with LazyHeap gives expected distances, other engines, queues and
+// the search picked by weights, also on graphs with other weight
+// types, are cross-checked against it. Side is the side of grid used
+// for A* heuristic, 0 if graph isn't a grid. Preprocessing of
+// contraction hierarchy grows fast on graphs with dense core, so it
+// runs on grid and on other graphs of at most ch_limit vertices.
+void run_all(
+  const char* dataset,
+  const std::vector<Edge>& edges,
+  const int side,
+  const int ch_limit,
+  ThreadPool& pool,
+  std::mt19937& rng)
+{
+  const CsrGraph csr = CsrGraph::build(edges);
+  std::cout << dataset << " (" << csr.size() << " vertices, "
+	    << csr.edges() << " edges)\n";
+
+  const std::vector<int> sources = pick_sources(csr, rng);
+  std::vector<std::vector<int>> expected(sources.size());
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    dijkstra<LazyHeap>(csr, sources[i], expected[i]);
+  }
+
+  run<dijkstra<LazyHeap>>("lazy-heap", csr, sources, expected);
+  run<dijkstra<IndexedHeap>>("4-ary-heap", csr, sources, expected);
+  run<dijkstra<RadixHeap>>("radix-heap", csr, sources, expected);
+  run<dijkstra>("by-weights", csr, sources, expected);
+  const auto by_weights = [](const auto& graph, int s, auto& distances)
+  {
+    dijkstra(graph, s, distances);
+  };
+  run_typed<std::int64_t>("by-weights-int64", edges, sources, expected,
+			  by_weights);
+  run_typed<float>("by-weights-float", edges, sources, expected,
+		   by_weights);
+
+  run_bellman_ford("bf-passes", BellmanFordMode::passes, csr, sources,
+		   expected);
+  run_bellman_ford("bf-queue", BellmanFordMode::queue, csr, sources,
+		   expected);
+  run_bellman_ford("bf-slf", BellmanFordMode::slf, csr, sources, expected);
+  run_bellman_ford("bf-lll", BellmanFordMode::lll, csr, sources, expected);
+  run_bellman_ford("bf-slf-lll", BellmanFordMode::slf_lll, csr, sources,
+		   expected);
+  const auto lll = [](const auto& graph, int s, auto& distances)
+  {
+    bellman_ford(graph, s, distances, BellmanFordMode::lll);
+  };
+  run_typed<float>("bf-lll-float", edges, {sources[0]}, expected, lll);
+  run_typed<double>("bf-lll-double", edges, {sources[0]}, expected, lll);
+  run_negative_cycle(csr, sources, expected);
+
+  run_delta_stepping(pool, 0, csr, sources, expected);
+  run_delta_stepping(pool, 1, csr, sources, expected);
+  const auto delta_stepping = [&](const auto& graph, int s, auto& distances)
+  {
+    DeltaStepping engine(graph, pool);
+    engine.run(s, distances);
+  };
+  run_typed<std::int64_t>("delta-stepping-int64", edges, sources, expected,
+			  delta_stepping);
+  run_typed<float>("delta-stepping-float", edges, sources, expected,
+		   delta_stepping);
+  run_multi_source(pool, csr, sources, expected);
+  run_dynamic(csr, edges, sources, rng);
+
+  // Manhattan distance is a lower bound on grid with weights >= 1,
+  // dense indexes of grid vertices are their ids.
+  run_point_to_point(csr, sources, expected, [side](int v, int t)
+  {
+    if (side == 0)
+    {
+      return 0;
+    }
+    return std::abs(v % side - t % side) + std::abs(v / side - t / side);
+  }, rng);
+
+  if (side != 0 || csr.size() <= ch_limit)
+  {
+    run_contraction(pool, csr, sources, expected, rng);
+  }
+  else
+  {
+    std::cout << "  ch: skipped, more than " << ch_limit << " vertices\n";
+  }
+}
+
+// Run engines which allow negative weights on the graph with some of
+// its weights made negative by potentials. Expected distances are
+// found by dijkstra on the original graph and shifted by potentials,
+// so both algorithms are checked against each other.
+void run_negative(
+  const char* dataset,
+  std::vector<Edge> edges,
+  const int spread,
+  std::mt19937& rng)
+{
+  // Distances of the original graph may not fit int, while shifted
+  // ones do, so expected distances are found with 64-bit weights.
+  using WideGraph = BasicCsrGraph<int, long long>;
+  std::vector<WideGraph::EdgeType> wide;
+  wide.reserve(edges.size());
+  for (const auto& edge: edges)
+  {
+    wide.push_back({edge.a, edge.b, edge.w});
+  }
+  const WideGraph original = WideGraph::build(wide);
+  const std::vector<int> potentials = add_potentials(edges, spread, rng);
+  const CsrGraph csr = CsrGraph::build(edges);
+
+  long long negative = 0;
+  for (const auto& edge: edges)
+  {
+    negative += edge.w < 0;
+  }
+  std::cout << dataset << " (" << csr.size() << " vertices, "
+	    << csr.edges() << " edges, " << negative << " negative)\n";
+
+  // Both graphs are built from the same ids, so dense indexes match.
+  const std::vector<int> sources = pick_sources(csr, rng);
+  std::vector<long long> distances;
+  dijkstra<LazyHeap>(original, sources[0], distances);
+  std::vector<std::vector<int>> expected(1);
+  expected[0].assign(csr.size(), std::numeric_limits<int>::max());
+  const int ps = potentials[csr.id(sources[0])];
+  for (int v = 0; v < csr.size(); ++v)
+  {
+    if (distances[v] == std::numeric_limits<long long>::max())
+    {
+      continue;
+    }
+
+    // Prefixes of shortest paths are shortest paths too, so int
+    // engines saturate on the way to some vertex only if its own
+    // distance doesn't fit int. Such graphs can't be checked.
+    const long long d = distances[v] + ps - potentials[csr.id(v)];
+    if (d < std::numeric_limits<int>::lowest()
+	|| d >= std::numeric_limits<int>::max())
+    {
+      std::cout << "  skipped, distances don't fit int\n";
+      return;
+    }
+    expected[0][v] = d;
+  }
+
+  run_bellman_ford("bf-passes", BellmanFordMode::passes, csr, sources,
+		   expected);
+  run_bellman_ford("bf-queue", BellmanFordMode::queue, csr, sources,
+		   expected);
+  run_bellman_ford("bf-slf", BellmanFordMode::slf, csr, sources, expected);
+  run_bellman_ford("bf-lll", BellmanFordMode::lll, csr, sources, expected);
+  run_bellman_ford("bf-slf-lll", BellmanFordMode::slf_lll, csr, sources,
+		   expected);
+  run_negative_cycle(csr, sources, expected);
+}
+
+void print_usage()
+{
+  std::cout << "usage: bench [options]\n"
+	    << "-n num   amount of vertices (default 250000)\n"
+	    << "-d num   average out degree (default 8)\n"
+	    << "-w num   maximum weight of edge (default 100)\n"
+	    << "-s seed  seed of random generator\n"
+	    << "-t num   amount of threads (default is all hardware threads)\n"
+	    << "-c num   maximum vertices of non-grid graph for contraction\n"
+	    << "         hierarchy (default 1024)\n";
+}
+
+int main(int argc, char* argv[])
+{
+  int n = 250000;
+  int degree = 8;
+  int max_weight = 100;
+  unsigned seed = 1;
+  unsigned threads = 0;
+  int ch_limit = 1024;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:d:w:s:t:c:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'n':
+      n = std::strtol(optarg, nullptr, 10);
+      break;
+    case 'd':
+      degree = std::strtol(optarg, nullptr, 10);
+      break;
+    case 'w':
+      max_weight = std::strtol(optarg, nullptr, 10);
+      break;
+    case 's':
+      seed = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 't':
+      threads = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'c':
+      ch_limit = std::strtol(optarg, nullptr, 10);
+      break;
+    default:
+      print_usage();
+      return 1;
+    }
+  }
+
+  // Potentials of negative graphs move weights by up to max_weight
+  // both ways, they have to fit int.
+  if (n < 16 || n > (1 << 30) || degree < 2 || max_weight < 1
+      || max_weight > std::numeric_limits<int>::max() / 2)
+  {
+    print_usage();
+    return 1;
+  }
+
+  ThreadPool pool(threads);
+  std::mt19937 rng(seed);
+  int side = 1;
+  while ((side + 1) * (side + 1) <= n)
+  {
+    ++side;
+  }
+  int scale = 1;
+  while ((1 << scale) < n)
+  {
+    ++scale;
+  }
+  const long long m = static_cast<long long>(n) * degree;
+
+  run_all("grid", make_grid(side, max_weight, rng), side, ch_limit, pool,
+	  rng);
+  run_all("erdos-renyi", make_erdos_renyi(n, m - n, max_weight, rng), 0,
+	  ch_limit, pool, rng);
+  run_all("rmat", make_rmat(scale, m, max_weight, rng), 0, ch_limit, pool,
+	  rng);
+  run_all("social", make_social(n, degree / 2, max_weight, rng), 0,
+	  ch_limit, pool, rng);
+
+  run_negative("grid-negative", make_grid(side, max_weight, rng),
+	       max_weight, rng);
+  run_negative("erdos-renyi-negative",
+	       make_erdos_renyi(n, m - n, max_weight, rng), max_weight, rng);
+
+  if (g_failures != 0)
+  {
+    std::cerr << g_failures << " checks failed\n";
+    return 1;
+  }
+  return 0;
+}
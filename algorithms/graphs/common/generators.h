@@ -0,0 +1,166 @@
+#ifndef _GRAPHS_COMMON_GENERATORS_H
+#define _GRAPHS_COMMON_GENERATORS_H
+
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "graph.h"
+
+// Generators of synthetic workloads. Every generator returns a list
+// of edges over vertex ids 0..n-1 with random weights in
+// [1, max_weight], to be built with CsrGraph::build. Generators are
+// deterministic for a given state of rng.
+
+// Road-like graph: side x side grid with edges in both directions
+// between neighbours. Id of vertex (x, y) is y * side + x.
+inline std::vector<Edge> make_grid(
+  int side, int max_weight, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> weight(1, max_weight);
+  std::vector<Edge> edges;
+  edges.reserve(4 * static_cast<std::size_t>(side) * side);
+  for (int y = 0; y < side; ++y)
+  {
+    for (int x = 0; x < side; ++x)
+    {
+      const int v = y * side + x;
+      if (x + 1 < side)
+      {
+	edges.push_back({v, v + 1, weight(rng)});
+	edges.push_back({v + 1, v, weight(rng)});
+      }
+      if (y + 1 < side)
+      {
+	edges.push_back({v, v + side, weight(rng)});
+	edges.push_back({v + side, v, weight(rng)});
+      }
+    }
+  }
+  return edges;
+}
+
+// Erdos-Renyi G(n, m) graph: m directed edges with both ends picked
+// uniformly. Every vertex also gets an edge to the next one, so that
+// the graph is strongly connected and has exactly n vertices.
+inline std::vector<Edge> make_erdos_renyi(
+  int n, long long m, int max_weight, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> weight(1, max_weight);
+  std::uniform_int_distribution<int> vertex(0, n - 1);
+  std::vector<Edge> edges;
+  edges.reserve(n + m);
+  for (int v = 0; v < n; ++v)
+  {
+    edges.push_back({v, (v + 1) % n, weight(rng)});
+  }
+  for (long long i = 0; i < m; ++i)
+  {
+    const int a = vertex(rng);
+    edges.push_back({a, vertex(rng), weight(rng)});
+  }
+  return edges;
+}
+
+// R-MAT graph of 2^scale vertex ids and m directed edges. Every edge
+// descends scale levels of the adjacency matrix, picking one of its
+// quadrants with probabilities a, b, c and 1 - a - b - c, which gives
+// power law degrees and community structure. Defaults are the ones of
+// Graph500. Vertices without edges are absent from the graph.
+inline std::vector<Edge> make_rmat(
+  int scale, long long m, int max_weight, std::mt19937& rng,
+  double a = 0.57, double b = 0.19, double c = 0.19)
+{
+  std::uniform_int_distribution<int> weight(1, max_weight);
+  std::uniform_real_distribution<double> coin(0, 1);
+  std::vector<Edge> edges;
+  edges.reserve(m);
+  for (long long i = 0; i < m; ++i)
+  {
+    int row = 0;
+    int column = 0;
+    for (int level = 0; level < scale; ++level)
+    {
+      const double p = coin(rng);
+      row = 2 * row + (p >= a + b);
+      column = 2 * column + ((p >= a && p < a + b) || p >= a + b + c);
+    }
+    edges.push_back({row, column, weight(rng)});
+  }
+
+  // Permute ids, otherwise high degree vertices have small ids.
+  std::vector<int> permutation(1 << scale);
+  for (std::size_t v = 0; v < permutation.size(); ++v)
+  {
+    permutation[v] = v;
+  }
+  std::shuffle(permutation.begin(), permutation.end(), rng);
+  for (auto& edge: edges)
+  {
+    edge.a = permutation[edge.a];
+    edge.b = permutation[edge.b];
+  }
+  return edges;
+}
+
+// Social-like graph: preferential attachment, every new vertex links
+// to degree vertices picked proportionally to their degree, so degree
+// distribution follows power law. Edges go in both directions.
+inline std::vector<Edge> make_social(
+  int n, int degree, int max_weight, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> weight(1, max_weight);
+  std::vector<Edge> edges;
+
+  // Every edge adds both of its ends here, so uniform pick of an
+  // element is a pick of vertex proportional to its degree.
+  std::vector<int> ends;
+  for (int v = 1; v <= degree; ++v)
+  {
+    edges.push_back({0, v, weight(rng)});
+    edges.push_back({v, 0, weight(rng)});
+    ends.push_back(0);
+    ends.push_back(v);
+  }
+
+  for (int v = degree + 1; v < n; ++v)
+  {
+    for (int i = 0; i < degree; ++i)
+    {
+      const int u = ends[rng() % ends.size()];
+      edges.push_back({v, u, weight(rng)});
+      edges.push_back({u, v, weight(rng)});
+      ends.push_back(u);
+      ends.push_back(v);
+    }
+  }
+  return edges;
+}
+
+// Make some weights of the graph negative without making negative
+// cycles. Every vertex gets random potential p(v) in [0, spread] and
+// weight of edge a->b becomes w + p(a) - p(b). Weight of every cycle
+// is unchanged, and distance from s to v changes by p(s) - p(v), so
+// shortest paths stay the same. Returns potentials of vertex ids.
+inline std::vector<int> add_potentials(
+  std::vector<Edge>& edges, int spread, std::mt19937& rng)
+{
+  int n = 0;
+  for (const auto& edge: edges)
+  {
+    n = std::max(n, std::max(edge.a, edge.b) + 1);
+  }
+
+  std::uniform_int_distribution<int> potential(0, spread);
+  std::vector<int> potentials(n);
+  for (auto& p: potentials)
+  {
+    p = potential(rng);
+  }
+  for (auto& edge: edges)
+  {
+    edge.w += potentials[edge.a] - potentials[edge.b];
+  }
+  return potentials;
+}
+
+#endif  // _GRAPHS_COMMON_GENERATORS_H
@@ -0,0 +1,632 @@
+#ifndef _GRAPHS_COMMON_GRAPH_H
+#define _GRAPHS_COMMON_GRAPH_H
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_set>
+#include <unordered_map>
+#include "weights.h"
+
+// Graphs are templates over type of vertex ids, Vertex, and type of
+// weights, Weight. Vertex is an integer type, which also stores dense
+// indexes, so it bounds amount of vertices. Weight is an integer or
+// floating point type, see weights.h for arithmetic of distances.
+// Narrow types make edges smaller: edge of CSR form takes
+// sizeof(Vertex) + sizeof(Weight) bytes.
+//
+// Engines are templates over the graph and accept any BasicCsrGraph,
+// their distances are DistanceTraits<Weight>::Distance. CsrGraph, with
+// int ids, as edge list formats allow negative ids, and int weights,
+// is the graph of the loader and the bench.
+
+// Weighted edge a-(w)->b
+template <typename Vertex, typename Weight>
+struct BasicEdge
+{
+  Vertex a;
+  Vertex b;
+  Weight w;
+};
+
+// Immutable graph in compressed sparse row form. Vertex ids of the
+// source graph are remapped to dense indexes 0..V-1 (in increasing
+// order of ids), out edges of vertex v are stored contiguously at
+// positions [offsets[v], offsets[v + 1]) of targets and weights.
+// Source of an edge is implied by its position, so traversal of
+// successors is a linear scan.
+//
+// All arrays live in one block laid out as
+//
+//   ids[V] offsets[V + 1] targets[E] weights[E]
+//
+// where ids and targets are of Vertex type, offsets are int, weights
+// are of Weight type, and every array is aligned for its type. Block
+// is shared between copies of the graph. Block may be owned by the
+// graph or be a memory mapped file, see loader.h.
+template <typename Vertex = std::uint32_t, typename Weight = int>
+class BasicCsrGraph
+{
+  static_assert(std::is_integral_v<Vertex>, "vertex must be an integer");
+
+public:
+
+  using VertexType = Vertex;
+  using WeightType = Weight;
+  using EdgeType = BasicEdge<Vertex, Weight>;
+
+  // Make empty graph.
+  BasicCsrGraph();
+
+  // Make graph of n vertices and m edges over the block.
+  BasicCsrGraph(std::shared_ptr<const char> block, int n, int m);
+
+  // Build graph from the list of edges. Vertices of the graph are
+  // ends of the edges, edges of every vertex keep their order in the
+  // list.
+  static BasicCsrGraph build(const std::vector<EdgeType>& edges);
+
+  // Same as build, also every id of [first, last] is a vertex of the
+  // graph, with or without edges. Range is empty if first > last.
+  static BasicCsrGraph build(
+    const std::vector<EdgeType>& edges, Vertex first, Vertex last);
+
+  // Get amount of vertices.
+  int size() const;
+
+  // Get amount of edges.
+  int edges() const;
+
+  // Get dense index of vertex id, -1 if there is no such vertex.
+  int index(Vertex id) const;
+
+  // Get vertex id of dense index v.
+  Vertex id(int v) const;
+
+  // Get position of the first out edge of v.
+  int begin(int v) const;
+
+  // Get position after the last out edge of v.
+  int end(int v) const;
+
+  // Get target of edge at position e.
+  int target(int e) const;
+
+  // Get weight of edge at position e.
+  Weight weight(int e) const;
+
+  // Get the smallest and the largest weight of edges, 0 if there are
+  // no edges. They let shortest path searches pick a queue, see
+  // dijkstra().
+  Weight min_weight() const;
+  Weight max_weight() const;
+
+  // Build graph with every edge reversed and the same dense indexes.
+  BasicCsrGraph reverse() const;
+
+  // Build graph with the same vertices and edges and weights of type
+  // Other, edge at position e out of v gets weight(v, e).
+  template <typename Other, typename F>
+  BasicCsrGraph<Vertex, Other> with_weights(F weight) const;
+
+  // Get block of the arrays.
+  const char* block() const;
+
+  // Get amount of bytes in block of graph of n vertices and m edges.
+  static std::size_t block_size(int n, int m);
+
+private:
+
+  // Graphs of other weights share layout and allocation.
+  template <typename, typename>
+  friend class BasicCsrGraph;
+
+  // Positions of arrays in block, in bytes.
+  struct Layout
+  {
+    std::size_t ids;
+    std::size_t offsets;
+    std::size_t targets;
+    std::size_t weights;
+    std::size_t size;
+  };
+
+  // Get layout of block of graph of n vertices and m edges.
+  static Layout layout(int n, int m);
+
+  // Allocate zeroed block for graph of n vertices and m edges.
+  static std::shared_ptr<char> allocate(int n, int m);
+
+  int n_;
+  int m_;
+
+  // Storage of the arrays below.
+  std::shared_ptr<const char> block_;
+
+  // Vertex ids of dense indexes, in increasing order.
+  const Vertex* ids_;
+
+  // Edges of vertex v are [offsets_[v], offsets_[v + 1]).
+  const int* offsets_;
+
+  // Targets and weights of edges.
+  const Vertex* targets_;
+  const Weight* weights_;
+
+  // Range of weights.
+  Weight min_weight_;
+  Weight max_weight_;
+};
+
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Weight>::BasicCsrGraph()
+  : BasicCsrGraph(allocate(0, 0), 0, 0)
+{
+}
+
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Weight>::BasicCsrGraph(
+  std::shared_ptr<const char> block, int n, int m)
+  : n_(n),
+    m_(m),
+    block_(std::move(block)),
+    min_weight_(0),
+    max_weight_(0)
+{
+  const Layout positions = layout(n, m);
+  const char* base = block_.get();
+  ids_ = reinterpret_cast<const Vertex*>(base + positions.ids);
+  offsets_ = reinterpret_cast<const int*>(base + positions.offsets);
+  targets_ = reinterpret_cast<const Vertex*>(base + positions.targets);
+  weights_ = reinterpret_cast<const Weight*>(base + positions.weights);
+  if (m != 0)
+  {
+    const auto [low, high] = std::minmax_element(weights_, weights_ + m);
+    min_weight_ = *low;
+    max_weight_ = *high;
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline typename BasicCsrGraph<Vertex, Weight>::Layout
+BasicCsrGraph<Vertex, Weight>::layout(int n, int m)
+{
+  auto align = [](std::size_t position, std::size_t alignment)
+  {
+    return (position + alignment - 1) / alignment * alignment;
+  };
+
+  const std::size_t vertices = n;
+  const std::size_t edges = m;
+  Layout positions;
+  positions.ids = 0;
+  positions.offsets = align(vertices * sizeof(Vertex), alignof(int));
+  positions.targets = align(positions.offsets + (vertices + 1) * sizeof(int),
+			    alignof(Vertex));
+  positions.weights = align(positions.targets + edges * sizeof(Vertex),
+			    alignof(Weight));
+  positions.size = positions.weights + edges * sizeof(Weight);
+  return positions;
+}
+
+template <typename Vertex, typename Weight>
+inline std::size_t BasicCsrGraph<Vertex, Weight>::block_size(int n, int m)
+{
+  return layout(n, m).size;
+}
+
+template <typename Vertex, typename Weight>
+inline std::shared_ptr<char> BasicCsrGraph<Vertex, Weight>::allocate(
+  int n, int m)
+{
+  // Elements of max_align_t give alignment for any of the arrays.
+  // Their value initialization may skip padding bytes, so block is
+  // zeroed explicitly: offsets are counted from zero and padding is
+  // written to cache files.
+  const std::size_t count =
+    (block_size(n, m) + sizeof(std::max_align_t) - 1)
+    / sizeof(std::max_align_t);
+  const auto storage =
+    std::make_shared<std::vector<std::max_align_t>>(count);
+  std::memset(storage->data(), 0, count * sizeof(std::max_align_t));
+  return std::shared_ptr<char>(
+    storage, reinterpret_cast<char*>(storage->data()));
+}
+
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Weight> BasicCsrGraph<Vertex, Weight>::build(
+  const std::vector<EdgeType>& edges)
+{
+  return build(edges, 1, 0);
+}
+
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Weight> BasicCsrGraph<Vertex, Weight>::build(
+  const std::vector<EdgeType>& edges, Vertex first, Vertex last)
+{
+  // Find ids of vertices. If ids are compact, which is the case for
+  // most of edge list formats, index of id is found in a table,
+  // otherwise ids are sorted and searched. Differences of ids are
+  // taken as unsigned, so they don't overflow.
+  using Unsigned = std::make_unsigned_t<Vertex>;
+  const std::size_t m = edges.size();
+  const bool isolated = first <= last;
+  const std::size_t count = isolated
+    ? static_cast<std::size_t>(static_cast<Unsigned>(last) - first) + 1
+    : 0;
+  std::vector<Vertex> ids;
+  std::vector<int> table;
+  Vertex low = 0;
+  if (m != 0 || isolated)
+  {
+    low = m != 0 ? edges[0].a : first;
+    Vertex high = low;
+    for (const auto& edge: edges)
+    {
+      low = std::min(low, std::min(edge.a, edge.b));
+      high = std::max(high, std::max(edge.a, edge.b));
+    }
+    if (isolated)
+    {
+      low = std::min(low, first);
+      high = std::max(high, last);
+    }
+
+    const Unsigned range = static_cast<Unsigned>(high) - low;
+    if (range < 4 * m + count + 1024)
+    {
+      table.assign(static_cast<std::size_t>(range) + 1, -1);
+      for (const auto& edge: edges)
+      {
+	table[static_cast<Unsigned>(edge.a) - low] = 0;
+	table[static_cast<Unsigned>(edge.b) - low] = 0;
+      }
+      for (std::size_t i = 0; i < count; ++i)
+      {
+	table[static_cast<Unsigned>(first) - low + i] = 0;
+      }
+      for (std::size_t i = 0; i < table.size(); ++i)
+      {
+	if (table[i] == 0)
+	{
+	  table[i] = ids.size();
+	  ids.push_back(static_cast<Vertex>(low + i));
+	}
+      }
+    }
+    else
+    {
+      ids.reserve(2 * m + count);
+      for (const auto& edge: edges)
+      {
+	ids.push_back(edge.a);
+	ids.push_back(edge.b);
+      }
+      for (std::size_t i = 0; i < count; ++i)
+      {
+	ids.push_back(static_cast<Vertex>(first + i));
+      }
+      std::sort(ids.begin(), ids.end());
+      ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+  }
+
+  auto dense = [&](Vertex id)
+  {
+    if (!table.empty())
+    {
+      return table[static_cast<Unsigned>(id) - low];
+    }
+    return static_cast<int>(
+      std::lower_bound(ids.cbegin(), ids.cend(), id) - ids.cbegin());
+  };
+
+  const int n = ids.size();
+  const auto block = allocate(n, m);
+  const Layout positions = layout(n, m);
+  Vertex* out_ids = reinterpret_cast<Vertex*>(block.get() + positions.ids);
+  int* offsets = reinterpret_cast<int*>(block.get() + positions.offsets);
+  Vertex* targets =
+    reinterpret_cast<Vertex*>(block.get() + positions.targets);
+  Weight* weights =
+    reinterpret_cast<Weight*>(block.get() + positions.weights);
+  std::copy(ids.cbegin(), ids.cend(), out_ids);
+
+  // Count out edges of every vertex and turn counts into offsets.
+  std::vector<int> sources(m);
+  for (std::size_t e = 0; e < m; ++e)
+  {
+    sources[e] = dense(edges[e].a);
+    ++offsets[sources[e] + 1];
+  }
+  for (int v = 0; v < n; ++v)
+  {
+    offsets[v + 1] += offsets[v];
+  }
+
+  // Place edges in order of the list.
+  std::vector<int> next(offsets, offsets + n);
+  for (std::size_t e = 0; e < m; ++e)
+  {
+    const int position = next[sources[e]]++;
+    targets[position] = dense(edges[e].b);
+    weights[position] = edges[e].w;
+  }
+
+  return BasicCsrGraph(block, n, m);
+}
+
+template <typename Vertex, typename Weight>
+inline int BasicCsrGraph<Vertex, Weight>::size() const
+{
+  return n_;
+}
+
+template <typename Vertex, typename Weight>
+inline int BasicCsrGraph<Vertex, Weight>::edges() const
+{
+  return m_;
+}
+
+template <typename Vertex, typename Weight>
+inline int BasicCsrGraph<Vertex, Weight>::index(Vertex id) const
+{
+  if (n_ == 0 || id < ids_[0] || id > ids_[n_ - 1])
+  {
+    return -1;
+  }
+
+  // Contiguous ids are their own index.
+  using Unsigned = std::make_unsigned_t<Vertex>;
+  if (static_cast<Unsigned>(ids_[n_ - 1]) - ids_[0]
+      == static_cast<Unsigned>(n_ - 1))
+  {
+    return static_cast<Unsigned>(id) - ids_[0];
+  }
+
+  const Vertex* it = std::lower_bound(ids_, ids_ + n_, id);
+  if (*it != id)
+  {
+    return -1;
+  }
+  return it - ids_;
+}
+
+template <typename Vertex, typename Weight>
+inline Vertex BasicCsrGraph<Vertex, Weight>::id(int v) const
+{
+  return ids_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline int BasicCsrGraph<Vertex, Weight>::begin(int v) const
+{
+  return offsets_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline int BasicCsrGraph<Vertex, Weight>::end(int v) const
+{
+  return offsets_[v + 1];
+}
+
+template <typename Vertex, typename Weight>
+inline int BasicCsrGraph<Vertex, Weight>::target(int e) const
+{
+  return targets_[e];
+}
+
+template <typename Vertex, typename Weight>
+inline Weight BasicCsrGraph<Vertex, Weight>::weight(int e) const
+{
+  return weights_[e];
+}
+
+template <typename Vertex, typename Weight>
+inline Weight BasicCsrGraph<Vertex, Weight>::min_weight() const
+{
+  return min_weight_;
+}
+
+template <typename Vertex, typename Weight>
+inline Weight BasicCsrGraph<Vertex, Weight>::max_weight() const
+{
+  return max_weight_;
+}
+
+template <typename Vertex, typename Weight>
+inline const char* BasicCsrGraph<Vertex, Weight>::block() const
+{
+  return block_.get();
+}
+
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Weight>
+BasicCsrGraph<Vertex, Weight>::reverse() const
+{
+  const auto block = allocate(n_, m_);
+  const Layout positions = layout(n_, m_);
+  Vertex* ids = reinterpret_cast<Vertex*>(block.get() + positions.ids);
+  int* offsets = reinterpret_cast<int*>(block.get() + positions.offsets);
+  Vertex* targets =
+    reinterpret_cast<Vertex*>(block.get() + positions.targets);
+  Weight* weights =
+    reinterpret_cast<Weight*>(block.get() + positions.weights);
+  std::copy(ids_, ids_ + n_, ids);
+
+  // Count in edges of every vertex and turn counts into offsets.
+  for (int e = 0; e < m_; ++e)
+  {
+    ++offsets[targets_[e] + 1];
+  }
+  for (int v = 0; v < n_; ++v)
+  {
+    offsets[v + 1] += offsets[v];
+  }
+
+  std::vector<int> next(offsets, offsets + n_);
+  for (int a = 0; a < n_; ++a)
+  {
+    for (int e = begin(a); e < end(a); ++e)
+    {
+      const int r = next[targets_[e]]++;
+      targets[r] = a;
+      weights[r] = weights_[e];
+    }
+  }
+
+  return BasicCsrGraph(block, n_, m_);
+}
+
+template <typename Vertex, typename Weight>
+template <typename Other, typename F>
+inline BasicCsrGraph<Vertex, Other>
+BasicCsrGraph<Vertex, Weight>::with_weights(F weight) const
+{
+  using Result = BasicCsrGraph<Vertex, Other>;
+  const auto block = Result::allocate(n_, m_);
+  const auto positions = Result::layout(n_, m_);
+  Vertex* ids = reinterpret_cast<Vertex*>(block.get() + positions.ids);
+  int* offsets = reinterpret_cast<int*>(block.get() + positions.offsets);
+  Vertex* targets =
+    reinterpret_cast<Vertex*>(block.get() + positions.targets);
+  Other* weights = reinterpret_cast<Other*>(block.get() + positions.weights);
+  std::copy(ids_, ids_ + n_, ids);
+  std::copy(offsets_, offsets_ + n_ + 1, offsets);
+  std::copy(targets_, targets_ + m_, targets);
+  for (int v = 0; v < n_; ++v)
+  {
+    for (int e = begin(v); e < end(v); ++e)
+    {
+      weights[e] = weight(v, e);
+    }
+  }
+
+  return Result(block, n_, m_);
+}
+
+template <typename Vertex = std::uint32_t, typename Weight = int>
+class BasicGraph
+{
+public:
+
+  using EdgeType = BasicEdge<Vertex, Weight>;
+
+  // Make empty graph.
+  BasicGraph();
+
+  // Add weighted edge a-(w)->b.
+  void add_edge(Vertex a, Vertex b, Weight w);
+
+  // Get edges that lead to successors of node a.
+  const std::vector<EdgeType>& successors(Vertex a) const;
+
+  // Get all vertices of the graph.
+  const std::unordered_set<Vertex>& vertices() const;
+
+  // Get all edges of the graph.
+  const std::vector<EdgeType>& edges() const;
+
+  // Get the smallest and the largest weight of edges added so far, 0
+  // if there are no edges.
+  Weight min_weight() const;
+  Weight max_weight() const;
+
+  // Build compressed sparse row form of the graph. Edges of every
+  // vertex keep the order in which they were added.
+  BasicCsrGraph<Vertex, Weight> freeze() const;
+
+private:
+
+  // Adjacency list graph representation.
+  std::unordered_map<Vertex, std::vector<EdgeType>> adj_list_;
+
+  // All vertices of the graph.
+  std::unordered_set<Vertex> vertices_;
+
+  // All edges of the graph.
+  std::vector<EdgeType> edges_;
+
+  // Range of weights of edges_.
+  Weight min_weight_;
+  Weight max_weight_;
+
+  // Empty vector of successors to return.
+  std::vector<EdgeType> empty_;
+};
+
+template <typename Vertex, typename Weight>
+inline BasicGraph<Vertex, Weight>::BasicGraph()
+  : min_weight_(0),
+    max_weight_(0)
+{
+}
+
+template <typename Vertex, typename Weight>
+inline void BasicGraph<Vertex, Weight>::add_edge(
+  Vertex a, Vertex b, Weight w)
+{
+  min_weight_ = edges_.empty() ? w : std::min(min_weight_, w);
+  max_weight_ = edges_.empty() ? w : std::max(max_weight_, w);
+  adj_list_[a].push_back({a, b, w});
+  edges_.push_back({a, b, w});
+  vertices_.insert(a);
+  vertices_.insert(b);
+}
+
+template <typename Vertex, typename Weight>
+inline const std::vector<BasicEdge<Vertex, Weight>>&
+BasicGraph<Vertex, Weight>::successors(Vertex a) const
+{
+  const auto it = adj_list_.find(a);
+  if (it == adj_list_.cend())
+  {
+    return empty_;
+  }
+  return it->second;
+}
+
+template <typename Vertex, typename Weight>
+inline const std::unordered_set<Vertex>&
+BasicGraph<Vertex, Weight>::vertices() const
+{
+  return vertices_;
+}
+
+template <typename Vertex, typename Weight>
+inline const std::vector<BasicEdge<Vertex, Weight>>&
+BasicGraph<Vertex, Weight>::edges() const
+{
+  return edges_;
+}
+
+template <typename Vertex, typename Weight>
+inline Weight BasicGraph<Vertex, Weight>::min_weight() const
+{
+  return min_weight_;
+}
+
+template <typename Vertex, typename Weight>
+inline Weight BasicGraph<Vertex, Weight>::max_weight() const
+{
+  return max_weight_;
+}
+
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Weight> BasicGraph<Vertex, Weight>::freeze() const
+{
+  return BasicCsrGraph<Vertex, Weight>::build(edges_);
+}
+
+// Graphs of the engines. Their vertex ids stay signed int: the loader
+// accepts negative ids of edge lists, cache files store ids as int and
+// engines use int dense indexes with -1 for missing vertices.
+using Edge = BasicEdge<int, int>;
+using CsrGraph = BasicCsrGraph<int, int>;
+using Graph = BasicGraph<int, int>;
+
+#endif  // _GRAPHS_COMMON_GRAPH_H
@@ -0,0 +1,42 @@
+#ifndef _GRAPHS_COMMON_STATS_H
+#define _GRAPHS_COMMON_STATS_H
+
+// Operation counters of shortest path engines. They are compiled in
+// only with GRAPHS_STATS defined, otherwise GRAPHS_COUNT is a no-op.
+// Counters are shared by all threads and updated with relaxed atomics.
+//
+//   relaxations - edges examined by relaxation;
+//   pushes      - insertions into priority queues, buckets and queues;
+//   pops        - removals from them.
+
+#ifdef GRAPHS_STATS
+
+#include <atomic>
+
+struct Stats
+{
+  std::atomic<long long> relaxations{0};
+  std::atomic<long long> pushes{0};
+  std::atomic<long long> pops{0};
+
+  // Reset all counters.
+  void reset()
+  {
+    relaxations = 0;
+    pushes = 0;
+    pops = 0;
+  }
+};
+
+inline Stats g_stats;
+
+#define GRAPHS_COUNT(counter) \
+  g_stats.counter.fetch_add(1, std::memory_order_relaxed)
+
+#else
+
+#define GRAPHS_COUNT(counter) ((void) 0)
+
+#endif
+
+#endif  // _GRAPHS_COMMON_STATS_H
@@ -0,0 +1,195 @@
+#ifndef _GRAPHS_COMMON_THREAD_POOL_H
+#define _GRAPHS_COMMON_THREAD_POOL_H
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads which run tasks in lockstep. Task is a
+// function of thread number, every thread of the pool runs it once,
+// and the calling thread takes part as thread 0, so pool of one thread
+// has no workers and runs tasks inline.
+class ThreadPool
+{
+public:
+
+  // Make pool of threads, 0 means one thread per hardware thread.
+  explicit ThreadPool(unsigned threads = 0);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  // Get amount of threads including the calling one.
+  unsigned size() const;
+
+  // Run task(t) for every thread number t in [0, size()) and wait
+  // until all of them are done.
+  void run(const std::function<void(unsigned)>& task);
+
+  // Run f(i) for every i in [0, n). Threads claim chunks of grain
+  // consecutive indexes, so uneven work is balanced.
+  template <typename F>
+  void for_each(int n, int grain, F f);
+
+  // Same as for_each, but f(t, i) also gets thread number t, which is
+  // handy to address per-thread scratch state.
+  template <typename F>
+  void for_each_indexed(int n, int grain, F f);
+
+private:
+
+  // Body of worker thread t.
+  void work(unsigned t);
+
+  // Worker threads, thread number of workers_[i] is i + 1.
+  std::vector<std::thread> workers_;
+
+  // Protects everything below.
+  std::mutex mutex_;
+
+  // Signals workers about a new task or stop.
+  std::condition_variable start_;
+
+  // Signals run() that all workers are done.
+  std::condition_variable done_;
+
+  // Current task.
+  const std::function<void(unsigned)>* task_;
+
+  // Number of the current task, workers wait for it to change.
+  unsigned long generation_;
+
+  // Amount of workers which still run the current task.
+  unsigned pending_;
+
+  // Workers have to exit.
+  bool stop_;
+};
+
+inline ThreadPool::ThreadPool(unsigned threads)
+  : task_(nullptr), generation_(0), pending_(0), stop_(false)
+{
+  if (threads == 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned t = 1; t < threads; ++t)
+  {
+    workers_.emplace_back(&ThreadPool::work, this, t);
+  }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (auto& worker: workers_)
+  {
+    worker.join();
+  }
+}
+
+inline unsigned ThreadPool::size() const
+{
+  return workers_.size() + 1;
+}
+
+inline void ThreadPool::run(const std::function<void(unsigned)>& task)
+{
+  if (workers_.empty())
+  {
+    task(0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    pending_ = workers_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  task(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return pending_ == 0; });
+  task_ = nullptr;
+}
+
+inline void ThreadPool::work(unsigned t)
+{
+  unsigned long generation = 0;
+  for (;;)
+  {
+    const std::function<void(unsigned)>* task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] { return stop_ || generation_ != generation; });
+      if (stop_)
+      {
+	return;
+      }
+      generation = generation_;
+      task = task_;
+    }
+
+    (*task)(t);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0)
+      {
+	done_.notify_one();
+      }
+    }
+  }
+}
+
+template <typename F>
+void ThreadPool::for_each(int n, int grain, F f)
+{
+  for_each_indexed(n, grain, [&f](unsigned, int i) { f(i); });
+}
+
+template <typename F>
+void ThreadPool::for_each_indexed(int n, int grain, F f)
+{
+  if (n <= grain || workers_.empty())
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      f(0, i);
+    }
+    return;
+  }
+
+  std::atomic<int> next(0);
+  run([&](unsigned t)
+  {
+    for (;;)
+    {
+      const int begin = next.fetch_add(grain, std::memory_order_relaxed);
+      if (begin >= n)
+      {
+	break;
+      }
+      const int end = std::min(begin + grain, n);
+      for (int i = begin; i < end; ++i)
+      {
+	f(t, i);
+      }
+    }
+  });
+}
+
+#endif  // _GRAPHS_COMMON_THREAD_POOL_H
@@ -0,0 +1,66 @@
+#ifndef _GRAPHS_COMMON_WEIGHTS_H
+#define _GRAPHS_COMMON_WEIGHTS_H
+
+#include <limits>
+#include <type_traits>
+
+// Arithmetic of path distances for graphs with weights of type Weight:
+//
+//   integers narrower than int - distances are int;
+//   int and wider integers     - distances are of the same type;
+//   float                      - distances are double, which keeps long
+//                                sums from losing precision;
+//   double                     - distances are double.
+//
+// Integer additions saturate instead of overflowing.
+//
+// Unreachable vertices get infinity(), which is the largest distance
+// for integers and positive infinity for floating point. Saturated sum
+// is infinity() too, such paths are too long to be told apart from
+// missing ones.
+template <typename Weight>
+struct DistanceTraits
+{
+  static_assert(std::is_arithmetic_v<Weight>, "weight must be a number");
+
+  using Distance = std::conditional_t<
+    std::is_floating_point_v<Weight>,
+    std::conditional_t<(sizeof(Weight) < sizeof(double)), double, Weight>,
+    std::conditional_t<(sizeof(Weight) < sizeof(int)), int, Weight>>;
+
+  // Distance of unreachable vertex.
+  static constexpr Distance infinity()
+  {
+    if constexpr (std::is_floating_point_v<Distance>)
+    {
+      return std::numeric_limits<Distance>::infinity();
+    }
+    else
+    {
+      return std::numeric_limits<Distance>::max();
+    }
+  }
+
+  // Get d + w, where w is a weight or another distance. Integer sum
+  // which doesn't fit saturates to infinity() or to the lowest
+  // distance for negative w.
+  template <typename T>
+  static Distance add(Distance d, T w)
+  {
+    if constexpr (std::is_floating_point_v<Distance>)
+    {
+      return d + w;
+    }
+    else
+    {
+      Distance sum;
+      if (__builtin_add_overflow(d, w, &sum))
+      {
+	return w > 0 ? infinity() : std::numeric_limits<Distance>::lowest();
+      }
+      return sum;
+    }
+  }
+};
+
+#endif  // _GRAPHS_COMMON_WEIGHTS_H
@@ -0,0 +1,1141 @@
+#ifndef _GRAPHS_CONTRACTION_CONTRACTION_HIERARCHY_H
+#define _GRAPHS_CONTRACTION_CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <limits>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/thread_pool.h"
+
+// Contraction hierarchy of a graph with non-negative weights. Vertices
+// are contracted one by one in order of importance: contracted vertex
+// is removed from the graph and shortcut edges are added between its
+// neighbours where it was on the only shortest path. Rank of vertex is
+// its position in the contraction order. Every shortest path of the
+// graph has a counterpart in the hierarchy which goes up in rank and
+// then down, so query is bidirectional Dijkstra which relaxes only
+// upward edges from both ends and settles a tiny part of the graph.
+//
+// Vertices are dense indexes of the BasicCsrGraph the hierarchy is
+// built from. Distances are DistanceTraits<Weight>::Distance, weights
+// of arcs are stored as distances since shortcuts are sums of weights.
+template <typename Vertex, typename Weight>
+class ContractionHierarchy
+{
+public:
+
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Make empty hierarchy.
+  ContractionHierarchy();
+
+  // Build hierarchy of the graph on threads of the pool.
+  void build(const BasicCsrGraph<Vertex, Weight>& graph, ThreadPool& pool);
+
+  // Write hierarchy to file.
+  bool save(const char* fname) const;
+
+  // Read hierarchy from file written by save.
+  bool load(const char* fname);
+
+  // Get amount of vertices.
+  int size() const;
+
+  // Get dense index of vertex id, -1 if there is no such vertex.
+  int index(Vertex id) const;
+
+  // Get vertex id of dense index v.
+  Vertex id(int v) const;
+
+  // Get rank of vertex v.
+  int rank(int v) const;
+
+  // Get amount of shortcut edges.
+  int shortcuts() const;
+
+private:
+
+  template <typename, typename> friend class ChBuilder;
+  template <typename, typename> friend class ChQuery;
+
+  // Check that arrays read by load are consistent: ids increase,
+  // ranks are a permutation, offsets are monotone and end at the
+  // amount of arcs, arcs have non-negative weights and lead to higher
+  // ranked vertices and middles are ranked below both ends of their
+  // shortcuts. Queries rely on these to stay within the arrays and to
+  // terminate.
+  bool consistent() const;
+
+  // Edge of the hierarchy. Middle is the contracted vertex a shortcut
+  // bypasses, -1 for edges of the graph.
+  struct Arc
+  {
+    int vertex;
+    Distance weight;
+    int middle;
+  };
+
+  // Vertex ids of dense indexes.
+  std::vector<Vertex> ids_;
+
+  // Ranks of vertices.
+  std::vector<int> ranks_;
+
+  // Edges v->x to higher ranked x, they are [up_offsets_[v],
+  // up_offsets_[v + 1]) of up_ and vertex of the arc is x.
+  std::vector<int> up_offsets_;
+  std::vector<Arc> up_;
+
+  // Edges x->v from higher ranked x, stored at v the same way and
+  // vertex of the arc is x.
+  std::vector<int> down_offsets_;
+  std::vector<Arc> down_;
+
+  int shortcuts_;
+};
+
+// Procedure of building a hierarchy. Vertices are contracted in rounds:
+// every round takes vertices whose priority is less than priorities of
+// all their neighbours, which is an independent set, and contracts them
+// in parallel. Witness searches of the round don't pass through
+// vertices of the set, so decisions about shortcuts of different
+// vertices don't depend on each other. Priority is edge difference
+// (shortcuts added minus edges removed) plus amount of contracted
+// neighbours, which spreads contraction uniformly over the graph.
+//
+// Priorities are updated lazily: contraction of a neighbour only bumps
+// the count of contracted neighbours and marks vertex dirty, the edge
+// difference is estimated again when the vertex is selected for a
+// round. Vertex whose new priority isn't the least among its
+// neighbours anymore waits for the next rounds.
+template <typename Vertex, typename Weight>
+class ChBuilder
+{
+public:
+
+  using Hierarchy = ContractionHierarchy<Vertex, Weight>;
+  using Traits = typename Hierarchy::Traits;
+  using Distance = typename Hierarchy::Distance;
+
+  // Make builder of the graph.
+  ChBuilder(const BasicCsrGraph<Vertex, Weight>& graph, ThreadPool& pool);
+
+  // Contract all vertices and store the result.
+  void run(Hierarchy& hierarchy);
+
+private:
+
+  using Arc = typename Hierarchy::Arc;
+
+  // Maximal amount of vertices a witness search settles and maximal
+  // amount of edges of a witness path. If a witness isn't found within
+  // the limits, shortcut is added, which is safe. Priorities are
+  // estimated with cheaper searches.
+  static constexpr int contract_limit = 500;
+  static constexpr int contract_hops = 5;
+  static constexpr int estimate_limit = 50;
+  static constexpr int estimate_hops = 2;
+
+  // Edge of the remaining graph. Edge a->b is stored in out_[a] and in
+  // in_[b], twin is position of the other copy in the other list, so
+  // edges are removed and updated in constant time.
+  struct Link
+  {
+    int vertex;
+    Distance weight;
+    int middle;
+    int twin;
+  };
+
+  // Shortcut a-(weight)->b over middle.
+  struct Shortcut
+  {
+    int a;
+    int b;
+    Distance weight;
+    int middle;
+  };
+
+  // Witness search state of one thread.
+  struct Scratch
+  {
+    std::vector<Distance> distances;
+    std::vector<int> hops;
+    std::vector<int> touched;
+    std::vector<std::pair<Distance, int>> heap;
+
+    // Vertex is an out neighbour of the contracted vertex.
+    std::vector<char> targets;
+
+    // Shortcuts found by priority estimation.
+    std::vector<Shortcut> shortcuts;
+  };
+
+  // Find shortcuts needed to contract v with witness searches which
+  // settle at most limit vertices over paths of at most hops edges.
+  void contract(
+    Scratch& scratch,
+    int v,
+    int limit,
+    int hops,
+    std::vector<Shortcut>& shortcuts);
+
+  // Dijkstra from u over the remaining graph which avoids v and
+  // vertices being contracted. It stops when distance bound or limit
+  // of settled vertices is reached, or when all targets are settled.
+  // Edges of vertices reached over hops edges are not relaxed.
+  void witness(
+    Scratch& scratch,
+    int u,
+    int v,
+    Distance bound,
+    int limit,
+    int hops,
+    int targets);
+
+  // Compute priority of v.
+  int priority(Scratch& scratch, int v);
+
+  // Check whether v precedes all its neighbours in order of
+  // (priority, index).
+  bool first(int v) const;
+
+  // Add shortcuts [first, last), all of them from the same vertex, or
+  // lower weights of the existing edges. Positions of out edges of the
+  // vertex are looked up in a table, so every shortcut takes constant
+  // time.
+  void link(const Shortcut* first, const Shortcut* last);
+
+  // Remove link i of vertex x from lists, which are out_ or in_, and
+  // fix twin of the link moved in its place. Twins are the other
+  // lists.
+  static void unlink(
+    std::vector<std::vector<Link>>& lists,
+    std::vector<std::vector<Link>>& twins,
+    int x,
+    int i);
+
+  const BasicCsrGraph<Vertex, Weight>& graph_;
+
+  ThreadPool& pool_;
+
+  // Edges of the remaining graph, both directions.
+  std::vector<std::vector<Link>> out_;
+  std::vector<std::vector<Link>> in_;
+
+  // Position of out edge to vertex while link() runs, -1 otherwise.
+  std::vector<int> positions_;
+
+  // Vertex is contracted in the current round.
+  std::vector<char> contracting_;
+
+  // Amount of contracted neighbours of vertex.
+  std::vector<int> deleted_;
+
+  std::vector<int> priorities_;
+
+  // Scratch of every thread of the pool.
+  std::vector<Scratch> scratch_;
+};
+
+template <typename Vertex, typename Weight>
+inline ChBuilder<Vertex, Weight>::ChBuilder(
+  const BasicCsrGraph<Vertex, Weight>& graph, ThreadPool& pool)
+  : graph_(graph),
+    pool_(pool),
+    out_(graph.size()),
+    in_(graph.size()),
+    positions_(graph.size(), -1),
+    contracting_(graph.size(), 0),
+    deleted_(graph.size(), 0),
+    priorities_(graph.size(), 0),
+    scratch_(pool.size())
+{
+  for (auto& scratch: scratch_)
+  {
+    scratch.distances.assign(graph.size(), Traits::infinity());
+    scratch.hops.assign(graph.size(), 0);
+    scratch.targets.assign(graph.size(), 0);
+  }
+
+  // Parallel edges are merged, loops are useless for shortest paths.
+  std::vector<Shortcut> edges;
+  for (int a = 0; a < graph.size(); ++a)
+  {
+    edges.clear();
+    for (int e = graph.begin(a); e < graph.end(a); ++e)
+    {
+      if (graph.target(e) != a)
+      {
+	edges.push_back({a, graph.target(e), graph.weight(e), -1});
+      }
+    }
+    link(edges.data(), edges.data() + edges.size());
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void ChBuilder<Vertex, Weight>::link(
+  const Shortcut* first, const Shortcut* last)
+{
+  if (first == last)
+  {
+    return;
+  }
+
+  const int a = first->a;
+  auto& out = out_[a];
+  for (std::size_t i = 0; i < out.size(); ++i)
+  {
+    positions_[out[i].vertex] = i;
+  }
+
+  for (const Shortcut* s = first; s != last; ++s)
+  {
+    const int i = positions_[s->b];
+    if (i == -1)
+    {
+      positions_[s->b] = out.size();
+      out.push_back({s->b, s->weight, s->middle,
+	  static_cast<int>(in_[s->b].size())});
+      in_[s->b].push_back({a, s->weight, s->middle,
+	  static_cast<int>(out.size()) - 1});
+    }
+    else if (s->weight < out[i].weight)
+    {
+      out[i].weight = s->weight;
+      out[i].middle = s->middle;
+      auto& twin = in_[s->b][out[i].twin];
+      twin.weight = s->weight;
+      twin.middle = s->middle;
+    }
+  }
+
+  for (const auto& l: out)
+  {
+    positions_[l.vertex] = -1;
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void ChBuilder<Vertex, Weight>::unlink(
+  std::vector<std::vector<Link>>& lists,
+  std::vector<std::vector<Link>>& twins,
+  int x,
+  int i)
+{
+  auto& links = lists[x];
+  links[i] = links.back();
+  links.pop_back();
+  if (i < static_cast<int>(links.size()))
+  {
+    twins[links[i].vertex][links[i].twin].twin = i;
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void ChBuilder<Vertex, Weight>::witness(
+  Scratch& scratch,
+  int u,
+  int v,
+  Distance bound,
+  int limit,
+  int hops,
+  int targets)
+{
+  using Entry = std::pair<Distance, int>;
+  for (const int x: scratch.touched)
+  {
+    scratch.distances[x] = Traits::infinity();
+  }
+  scratch.touched.clear();
+  scratch.heap.clear();
+
+  scratch.distances[u] = 0;
+  scratch.hops[u] = 0;
+  scratch.touched.push_back(u);
+  scratch.heap.emplace_back(0, u);
+
+  int settled = 0;
+  while (!scratch.heap.empty() && settled < limit && targets > 0)
+  {
+    std::pop_heap(scratch.heap.begin(), scratch.heap.end(),
+		  std::greater<Entry>());
+    const auto [dx, x] = scratch.heap.back();
+    scratch.heap.pop_back();
+    if (dx > scratch.distances[x])
+    {
+      continue;
+    }
+    if (dx > bound)
+    {
+      break;
+    }
+    ++settled;
+    targets -= scratch.targets[x] && x != u;
+    if (scratch.hops[x] == hops)
+    {
+      continue;
+    }
+
+    for (const auto& l: out_[x])
+    {
+      const int y = l.vertex;
+      if (y == v || contracting_[y])
+      {
+	continue;
+      }
+      const Distance d = Traits::add(dx, l.weight);
+      if (d < scratch.distances[y])
+      {
+	if (scratch.distances[y] == Traits::infinity())
+	{
+	  scratch.touched.push_back(y);
+	}
+	scratch.distances[y] = d;
+	scratch.hops[y] = scratch.hops[x] + 1;
+	scratch.heap.emplace_back(d, y);
+	std::push_heap(scratch.heap.begin(), scratch.heap.end(),
+		       std::greater<Entry>());
+      }
+    }
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void ChBuilder<Vertex, Weight>::contract(
+  Scratch& scratch,
+  int v,
+  int limit,
+  int hops,
+  std::vector<Shortcut>& shortcuts)
+{
+  shortcuts.clear();
+  if (out_[v].empty())
+  {
+    return;
+  }
+
+  Distance longest = 0;
+  for (const auto& l: out_[v])
+  {
+    longest = std::max(longest, l.weight);
+    scratch.targets[l.vertex] = 1;
+  }
+
+  const int targets = out_[v].size();
+  for (const auto& in: in_[v])
+  {
+    const int u = in.vertex;
+    witness(scratch, u, v, Traits::add(in.weight, longest),
+	    limit, hops, targets - scratch.targets[u]);
+    for (const auto& out: out_[v])
+    {
+      const int w = out.vertex;
+      const Distance d = Traits::add(in.weight, out.weight);
+      if (w != u && scratch.distances[w] > d)
+      {
+	shortcuts.push_back({u, w, d, v});
+      }
+    }
+  }
+
+  for (const auto& l: out_[v])
+  {
+    scratch.targets[l.vertex] = 0;
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline int ChBuilder<Vertex, Weight>::priority(Scratch& scratch, int v)
+{
+  contract(scratch, v, estimate_limit, estimate_hops, scratch.shortcuts);
+  const int added = scratch.shortcuts.size();
+  const int removed = in_[v].size() + out_[v].size();
+  return added - removed + deleted_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline bool ChBuilder<Vertex, Weight>::first(int v) const
+{
+  auto before = [&](int a, int b)
+  {
+    return std::make_pair(priorities_[a], a)
+      < std::make_pair(priorities_[b], b);
+  };
+  for (const auto& l: out_[v])
+  {
+    if (!before(v, l.vertex))
+    {
+      return false;
+    }
+  }
+  for (const auto& l: in_[v])
+  {
+    if (!before(v, l.vertex))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Vertex, typename Weight>
+inline void ChBuilder<Vertex, Weight>::run(Hierarchy& hierarchy)
+{
+  const int n = graph_.size();
+  hierarchy.ids_.resize(n);
+  for (int v = 0; v < n; ++v)
+  {
+    hierarchy.ids_[v] = graph_.id(v);
+  }
+  hierarchy.ranks_.assign(n, -1);
+  hierarchy.shortcuts_ = 0;
+
+  // Hierarchy edges of every vertex, recorded when it's contracted.
+  std::vector<std::vector<Arc>> up(n);
+  std::vector<std::vector<Arc>> down(n);
+
+  pool_.for_each_indexed(n, 64, [&](unsigned t, int v)
+  {
+    priorities_[v] = priority(scratch_[t], v);
+  });
+
+  std::vector<int> remaining(n);
+  for (int v = 0; v < n; ++v)
+  {
+    remaining[v] = v;
+  }
+
+  std::vector<char> selected(n, 0);
+  std::vector<char> dirty(n, 0);
+  std::vector<int> candidates;
+  std::vector<int> stale;
+  std::vector<int> round;
+  std::vector<std::vector<Shortcut>> shortcuts;
+  std::vector<Shortcut> added;
+  int rank = 0;
+  while (!remaining.empty())
+  {
+    // Select vertices which precede all their neighbours.
+    pool_.for_each(remaining.size(), 256, [&](int i)
+    {
+      selected[remaining[i]] = first(remaining[i]);
+    });
+    candidates.clear();
+    stale.clear();
+    for (const int v: remaining)
+    {
+      if (selected[v])
+      {
+	candidates.push_back(v);
+	if (dirty[v])
+	{
+	  stale.push_back(v);
+	  dirty[v] = 0;
+	}
+      }
+    }
+
+    // Estimate priorities of dirty candidates again. Candidates are
+    // independent, so priorities of their neighbours don't change and
+    // candidate stays if it still precedes them.
+    pool_.for_each_indexed(stale.size(), 16, [&](unsigned t, int i)
+    {
+      priorities_[stale[i]] = priority(scratch_[t], stale[i]);
+    });
+    pool_.for_each(stale.size(), 256, [&](int i)
+    {
+      selected[stale[i]] = first(stale[i]);
+    });
+
+    round.clear();
+    for (const int v: candidates)
+    {
+      if (selected[v])
+      {
+	round.push_back(v);
+	contracting_[v] = 1;
+      }
+    }
+
+    // Find shortcuts of the round in parallel.
+    shortcuts.resize(round.size());
+    pool_.for_each_indexed(round.size(), 16, [&](unsigned t, int i)
+    {
+      contract(scratch_[t], round[i], contract_limit, contract_hops,
+	       shortcuts[i]);
+    });
+
+    // Record edges to neighbours, which are all contracted later,
+    // and remove contracted vertices from the remaining graph.
+    for (const int v: round)
+    {
+      hierarchy.ranks_[v] = rank++;
+      for (const auto& l: out_[v])
+      {
+	up[v].push_back({l.vertex, l.weight, l.middle});
+	unlink(in_, out_, l.vertex, l.twin);
+	++deleted_[l.vertex];
+	++priorities_[l.vertex];
+	dirty[l.vertex] = 1;
+      }
+      for (const auto& l: in_[v])
+      {
+	down[v].push_back({l.vertex, l.weight, l.middle});
+	unlink(out_, in_, l.vertex, l.twin);
+	++deleted_[l.vertex];
+	++priorities_[l.vertex];
+	dirty[l.vertex] = 1;
+      }
+      std::vector<Link>().swap(out_[v]);
+      std::vector<Link>().swap(in_[v]);
+      contracting_[v] = 0;
+    }
+
+    // Add shortcuts grouped by their source.
+    added.clear();
+    for (std::size_t i = 0; i < round.size(); ++i)
+    {
+      added.insert(added.end(), shortcuts[i].cbegin(), shortcuts[i].cend());
+    }
+    std::sort(added.begin(), added.end(),
+	      [](const Shortcut& x, const Shortcut& y) { return x.a < y.a; });
+    for (std::size_t i = 0, j = 0; i < added.size(); i = j)
+    {
+      while (j < added.size() && added[j].a == added[i].a)
+      {
+	++j;
+      }
+      link(added.data() + i, added.data() + j);
+    }
+
+    remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+				   [&](int v) { return hierarchy.ranks_[v] != -1; }),
+		    remaining.end());
+  }
+
+  // Pack edges into arrays, count shortcuts once.
+  auto pack = [&](std::vector<std::vector<Arc>>& arcs,
+		  std::vector<int>& offsets,
+		  std::vector<Arc>& out)
+  {
+    offsets.assign(n + 1, 0);
+    out.clear();
+    for (int v = 0; v < n; ++v)
+    {
+      out.insert(out.end(), arcs[v].cbegin(), arcs[v].cend());
+      offsets[v + 1] = out.size();
+      std::vector<Arc>().swap(arcs[v]);
+    }
+  };
+  pack(up, hierarchy.up_offsets_, hierarchy.up_);
+  pack(down, hierarchy.down_offsets_, hierarchy.down_);
+
+  for (const auto& arcs: {&hierarchy.up_, &hierarchy.down_})
+  {
+    for (const auto& arc: *arcs)
+    {
+      hierarchy.shortcuts_ += arc.middle != -1;
+    }
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline ContractionHierarchy<Vertex, Weight>::ContractionHierarchy()
+  : up_offsets_(1, 0), down_offsets_(1, 0), shortcuts_(0)
+{
+}
+
+template <typename Vertex, typename Weight>
+inline void ContractionHierarchy<Vertex, Weight>::build(
+  const BasicCsrGraph<Vertex, Weight>& graph, ThreadPool& pool)
+{
+  ChBuilder<Vertex, Weight> builder(graph, pool);
+  builder.run(*this);
+}
+
+template <typename Vertex, typename Weight>
+inline int ContractionHierarchy<Vertex, Weight>::size() const
+{
+  return ids_.size();
+}
+
+template <typename Vertex, typename Weight>
+inline int ContractionHierarchy<Vertex, Weight>::index(Vertex id) const
+{
+  const auto it = std::lower_bound(ids_.cbegin(), ids_.cend(), id);
+  if (it == ids_.cend() || *it != id)
+  {
+    return -1;
+  }
+  return it - ids_.cbegin();
+}
+
+template <typename Vertex, typename Weight>
+inline Vertex ContractionHierarchy<Vertex, Weight>::id(int v) const
+{
+  return ids_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline int ContractionHierarchy<Vertex, Weight>::rank(int v) const
+{
+  return ranks_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline int ContractionHierarchy<Vertex, Weight>::shortcuts() const
+{
+  return shortcuts_;
+}
+
+// Header of hierarchy file. It's followed by arrays ids, ranks,
+// up_offsets, up, down_offsets and down. Types of vertex ids and
+// distances are recorded as ch_type() codes, hierarchy is loaded only
+// with the types it was saved with.
+struct ChHeader
+{
+  char magic[8];
+  std::int64_t vertex_type;
+  std::int64_t distance_type;
+  std::int64_t vertices;
+  std::int64_t up;
+  std::int64_t down;
+  std::int64_t shortcuts;
+};
+
+constexpr char ch_magic[8] = {'C', 'H', 'I', 'E', 'R', 'A', 'R', '2'};
+
+// Get code of arithmetic type T: its size, whether it's floating point
+// and whether it's signed.
+template <typename T>
+constexpr std::int64_t ch_type()
+{
+  return sizeof(T) * 4 + std::is_floating_point_v<T> * 2
+    + std::is_signed_v<T>;
+}
+
+template <typename Vertex, typename Weight>
+inline bool ContractionHierarchy<Vertex, Weight>::save(
+  const char* fname) const
+{
+  FILE* out = fopen(fname, "wb");
+  if (out == nullptr)
+  {
+    std::cerr << __func__ << ": can't open " << fname << ": "
+	      << strerror(errno) << "\n";
+    return false;
+  }
+
+  ChHeader header;
+  memcpy(header.magic, ch_magic, sizeof(header.magic));
+  header.vertex_type = ch_type<Vertex>();
+  header.distance_type = ch_type<Distance>();
+  header.vertices = ids_.size();
+  header.up = up_.size();
+  header.down = down_.size();
+  header.shortcuts = shortcuts_;
+
+  auto write = [out](const auto& array)
+  {
+    using T = typename std::decay_t<decltype(array)>::value_type;
+    return array.empty()
+      || fwrite(array.data(), sizeof(T), array.size(), out) == array.size();
+  };
+  const bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+    && write(ids_) && write(ranks_)
+    && write(up_offsets_) && write(up_)
+    && write(down_offsets_) && write(down_);
+  if (fclose(out) != 0 || !ok)
+  {
+    std::cerr << __func__ << ": write error: " << strerror(errno) << "\n";
+    return false;
+  }
+  return true;
+}
+
+template <typename Vertex, typename Weight>
+inline bool ContractionHierarchy<Vertex, Weight>::load(const char* fname)
+{
+  FILE* in = fopen(fname, "rb");
+  if (in == nullptr)
+  {
+    std::cerr << __func__ << ": can't open " << fname << ": "
+	      << strerror(errno) << "\n";
+    return false;
+  }
+
+  // Counts are checked against size of the file before anything is
+  // allocated for them.
+  ChHeader header;
+  long size = -1;
+  if (fread(&header, sizeof(header), 1, in) == 1
+      && memcmp(header.magic, ch_magic, sizeof(header.magic)) == 0
+      && fseek(in, 0, SEEK_END) == 0)
+  {
+    size = ftell(in);
+  }
+  const std::int64_t limit = std::numeric_limits<int>::max();
+  if (size == -1 || fseek(in, sizeof(header), SEEK_SET) != 0
+      || header.vertex_type != ch_type<Vertex>()
+      || header.distance_type != ch_type<Distance>()
+      || header.vertices < 0 || header.vertices >= limit
+      || header.up < 0 || header.up > limit
+      || header.down < 0 || header.down > limit
+      || header.shortcuts < 0 || header.shortcuts > header.up + header.down
+      || static_cast<std::uint64_t>(size) != sizeof(header)
+      + header.vertices * sizeof(Vertex)
+      + (3 * header.vertices + 2) * sizeof(int)
+      + (header.up + header.down) * sizeof(Arc))
+  {
+    std::cerr << __func__ << ": " << fname << " is not a hierarchy\n";
+    fclose(in);
+    return false;
+  }
+
+  // Arrays are read into another hierarchy, so this one is unchanged
+  // if the file turns out to be broken.
+  ContractionHierarchy loaded;
+  loaded.ids_.resize(header.vertices);
+  loaded.ranks_.resize(header.vertices);
+  loaded.up_offsets_.resize(header.vertices + 1);
+  loaded.up_.resize(header.up);
+  loaded.down_offsets_.resize(header.vertices + 1);
+  loaded.down_.resize(header.down);
+  loaded.shortcuts_ = header.shortcuts;
+
+  auto read = [in](auto& array)
+  {
+    using T = typename std::decay_t<decltype(array)>::value_type;
+    return array.empty()
+      || fread(array.data(), sizeof(T), array.size(), in) == array.size();
+  };
+  const bool ok = read(loaded.ids_) && read(loaded.ranks_)
+    && read(loaded.up_offsets_) && read(loaded.up_)
+    && read(loaded.down_offsets_) && read(loaded.down_);
+  fclose(in);
+  if (!ok)
+  {
+    std::cerr << __func__ << ": " << fname << " is truncated\n";
+    return false;
+  }
+  if (!loaded.consistent())
+  {
+    std::cerr << __func__ << ": " << fname << " is corrupt\n";
+    return false;
+  }
+
+  std::swap(*this, loaded);
+  return true;
+}
+
+template <typename Vertex, typename Weight>
+inline bool ContractionHierarchy<Vertex, Weight>::consistent() const
+{
+  const int n = ids_.size();
+  std::vector<char> ranked(n, 0);
+  for (int v = 0; v < n; ++v)
+  {
+    if ((v != 0 && ids_[v - 1] >= ids_[v])
+	|| ranks_[v] < 0 || ranks_[v] >= n || ranked[ranks_[v]])
+    {
+      return false;
+    }
+    ranked[ranks_[v]] = 1;
+  }
+
+  auto valid = [&](const std::vector<int>& offsets,
+		   const std::vector<Arc>& arcs)
+  {
+    if (offsets[0] != 0 || offsets[n] != static_cast<int>(arcs.size()))
+    {
+      return false;
+    }
+    for (int v = 0; v < n; ++v)
+    {
+      if (offsets[v] > offsets[v + 1])
+      {
+	return false;
+      }
+      for (int i = offsets[v]; i < offsets[v + 1]; ++i)
+      {
+	const Arc& arc = arcs[i];
+	if (arc.vertex < 0 || arc.vertex >= n
+	    || ranks_[arc.vertex] <= ranks_[v] || !(arc.weight >= 0)
+	    || arc.middle < -1 || arc.middle >= n
+	    || (arc.middle != -1 && ranks_[arc.middle] >= ranks_[v]))
+	{
+	  return false;
+	}
+      }
+    }
+    return true;
+  };
+  return valid(up_offsets_, up_) && valid(down_offsets_, down_);
+}
+
+// Query engine of the hierarchy. Scratch arrays are allocated once per
+// engine and only vertices touched by a query are reset after it, so
+// one engine per thread answers queries in time proportional to the
+// searched part of the hierarchy. Searches use stall on demand to
+// prune vertices reached over non-shortest upward paths.
+template <typename Vertex, typename Weight>
+class ChQuery
+{
+public:
+
+  using Hierarchy = ContractionHierarchy<Vertex, Weight>;
+  using Traits = typename Hierarchy::Traits;
+  using Distance = typename Hierarchy::Distance;
+
+  // Make query engine of the hierarchy.
+  explicit ChQuery(const ContractionHierarchy<Vertex, Weight>& hierarchy);
+
+  // Get distance from s to t, Traits::infinity() if t is not
+  // reachable.
+  Distance distance(int s, int t);
+
+  // Same as distance, also stores path from s to t with shortcuts
+  // unpacked to edges of the graph. Path is cleared if t is not
+  // reachable.
+  Distance search(int s, int t, std::vector<int>& path);
+
+private:
+
+  using Entry = std::pair<Distance, int>;
+
+  // State of search in one direction.
+  struct Side
+  {
+    std::vector<Distance> distances;
+
+    // Previous vertex and middle of the arc from it.
+    std::vector<int> parents;
+    std::vector<int> middles;
+
+    std::vector<int> touched;
+    std::vector<Entry> heap;
+  };
+
+  // Reset side and start it from v.
+  void start(Side& side, int v);
+
+  // Run both searches and return the meeting vertex, -1 if there is
+  // none.
+  int meet(int s, int t, Distance& best);
+
+  // Append path of arc a->b over middle without a itself.
+  void unpack(int a, int b, int middle, std::vector<int>& path) const;
+
+  const Hierarchy& hierarchy_;
+
+  Side forward_;
+  Side backward_;
+};
+
+template <typename Vertex, typename Weight>
+inline ChQuery<Vertex, Weight>::ChQuery(
+  const ContractionHierarchy<Vertex, Weight>& hierarchy)
+  : hierarchy_(hierarchy)
+{
+  for (Side* side: {&forward_, &backward_})
+  {
+    side->distances.assign(hierarchy.size(), Traits::infinity());
+    side->parents.assign(hierarchy.size(), -1);
+    side->middles.assign(hierarchy.size(), -1);
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void ChQuery<Vertex, Weight>::start(Side& side, int v)
+{
+  for (const int x: side.touched)
+  {
+    side.distances[x] = Traits::infinity();
+  }
+  side.touched.clear();
+  side.heap.clear();
+
+  side.distances[v] = 0;
+  side.parents[v] = -1;
+  side.touched.push_back(v);
+  side.heap.emplace_back(0, v);
+}
+
+template <typename Vertex, typename Weight>
+inline int ChQuery<Vertex, Weight>::meet(int s, int t, Distance& best)
+{
+  start(forward_, s);
+  start(backward_, t);
+  best = Traits::infinity();
+  int middle = -1;
+
+  // Every side stops when its minimum reaches the best distance.
+  bool forward = true;
+  while (!forward_.heap.empty() || !backward_.heap.empty())
+  {
+    if (forward_.heap.empty() || backward_.heap.empty())
+    {
+      forward = !forward_.heap.empty();
+    }
+    Side& side = forward ? forward_ : backward_;
+    const Side& other = forward ? backward_ : forward_;
+    const auto& offsets = forward
+      ? hierarchy_.up_offsets_ : hierarchy_.down_offsets_;
+    const auto& arcs = forward ? hierarchy_.up_ : hierarchy_.down_;
+    const auto& stall_offsets = forward
+      ? hierarchy_.down_offsets_ : hierarchy_.up_offsets_;
+    const auto& stall_arcs = forward ? hierarchy_.down_ : hierarchy_.up_;
+    forward = !forward;
+
+    std::pop_heap(side.heap.begin(), side.heap.end(), std::greater<Entry>());
+    const auto [du, u] = side.heap.back();
+    side.heap.pop_back();
+    if (du >= best)
+    {
+      side.heap.clear();
+      continue;
+    }
+    if (du > side.distances[u])
+    {
+      continue;
+    }
+
+    // Stall on demand: if a higher ranked vertex reached by the search
+    // gives shorter distance to u over edge into u, then u isn't on a
+    // shortest path and its edges are not relaxed.
+    bool stalled = false;
+    for (int i = stall_offsets[u]; i < stall_offsets[u + 1] && !stalled; ++i)
+    {
+      const auto& arc = stall_arcs[i];
+      stalled = Traits::add(side.distances[arc.vertex], arc.weight) < du;
+    }
+    if (stalled)
+    {
+      continue;
+    }
+
+    if (Traits::add(du, other.distances[u]) < best)
+    {
+      best = Traits::add(du, other.distances[u]);
+      middle = u;
+    }
+
+    for (int i = offsets[u]; i < offsets[u + 1]; ++i)
+    {
+      const auto& arc = arcs[i];
+      const Distance d = Traits::add(du, arc.weight);
+      if (d < side.distances[arc.vertex])
+      {
+	if (side.distances[arc.vertex] == Traits::infinity())
+	{
+	  side.touched.push_back(arc.vertex);
+	}
+	side.distances[arc.vertex] = d;
+	side.parents[arc.vertex] = u;
+	side.middles[arc.vertex] = arc.middle;
+	side.heap.emplace_back(d, arc.vertex);
+	std::push_heap(side.heap.begin(), side.heap.end(),
+		       std::greater<Entry>());
+      }
+    }
+  }
+  return middle;
+}
+
+template <typename Vertex, typename Weight>
+inline typename ChQuery<Vertex, Weight>::Distance
+ChQuery<Vertex, Weight>::distance(int s, int t)
+{
+  Distance best;
+  meet(s, t, best);
+  return best;
+}
+
+template <typename Vertex, typename Weight>
+inline void ChQuery<Vertex, Weight>::unpack(
+  int a,
+  int b,
+  int middle,
+  std::vector<int>& path) const
+{
+  // Stack of arcs to unpack, the next arc of the path is on top.
+  std::vector<std::pair<std::pair<int, int>, int>> stack;
+  stack.push_back({{a, b}, middle});
+  while (!stack.empty())
+  {
+    const auto [ends, m] = stack.back();
+    stack.pop_back();
+    if (m == -1)
+    {
+      path.push_back(ends.second);
+      continue;
+    }
+
+    // Middle is ranked lower than both ends, so a->m is a down arc
+    // of m and m->b is an up arc of m.
+    int first = -1;
+    int second = -1;
+    for (int i = hierarchy_.down_offsets_[m];
+	 i < hierarchy_.down_offsets_[m + 1]; ++i)
+    {
+      if (hierarchy_.down_[i].vertex == ends.first)
+      {
+	first = hierarchy_.down_[i].middle;
+      }
+    }
+    for (int i = hierarchy_.up_offsets_[m];
+	 i < hierarchy_.up_offsets_[m + 1]; ++i)
+    {
+      if (hierarchy_.up_[i].vertex == ends.second)
+      {
+	second = hierarchy_.up_[i].middle;
+      }
+    }
+    stack.push_back({{m, ends.second}, second});
+    stack.push_back({{ends.first, m}, first});
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline typename ChQuery<Vertex, Weight>::Distance
+ChQuery<Vertex, Weight>::search(int s, int t, std::vector<int>& path)
+{
+  path.clear();
+  Distance best;
+  const int middle = meet(s, t, best);
+  if (middle == -1)
+  {
+    return best;
+  }
+
+  // Up arcs from s to middle, then down arcs from middle to t.
+  std::vector<int> chain;
+  for (int v = middle; v != s; v = forward_.parents[v])
+  {
+    chain.push_back(v);
+  }
+  path.push_back(s);
+  for (auto it = chain.crbegin(); it != chain.crend(); ++it)
+  {
+    unpack(forward_.parents[*it], *it, forward_.middles[*it], path);
+  }
+  for (int v = middle; v != t; v = backward_.parents[v])
+  {
+    unpack(v, backward_.parents[v], backward_.middles[v], path);
+  }
+  return best;
+}
+
+#endif  // _GRAPHS_CONTRACTION_CONTRACTION_HIERARCHY_H
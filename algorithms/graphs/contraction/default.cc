@@ -0,0 +1,43 @@
+
+#include <vector>
+#include <iostream>
+#include "contraction_hierarchy.h"
+
+int main()
+{
+
+  // 0----(4)---->1----(3)---->3
+  // |            ^
+  // |            |
+  // |           (2)
+  // |            |
+  // +----(1)---->2
+  Graph graph;
+  graph.add_edge(0, 1, 4);
+  graph.add_edge(0, 2, 1);
+  graph.add_edge(2, 1, 2);
+  graph.add_edge(1, 3, 3);
+  const CsrGraph csr = graph.freeze();
+  ThreadPool pool;
+  ContractionHierarchy<int, int> hierarchy;
+  hierarchy.build(csr, pool);
+  if (!hierarchy.save("example.ch") || !hierarchy.load("example.ch"))
+  {
+    return 1;
+  }
+
+  ChQuery query(hierarchy);
+  std::vector<int> path;
+  for (int v = 0; v < hierarchy.size(); ++v)
+  {
+    const int d = query.search(hierarchy.index(0), v, path);
+    std::cout << "v, rank, d, path: " << hierarchy.id(v) << ", "
+              << hierarchy.rank(v) << ", " << d << ",";
+    for (const int u: path)
+    {
+      std::cout << " " << hierarchy.id(u);
+    }
+    std::cout << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,30 @@
+
+#include <vector>
+#include <iostream>
+#include "delta_stepping.h"
+
+int main()
+{
+
+  // 0----(4)---->1----(3)---->3
+  // |            ^
+  // |            |
+  // |           (2)
+  // |            |
+  // +----(1)---->2
+  Graph graph;
+  graph.add_edge(0, 1, 4);
+  graph.add_edge(0, 2, 1);
+  graph.add_edge(2, 1, 2);
+  graph.add_edge(1, 3, 3);
+  const CsrGraph csr = graph.freeze();
+  ThreadPool pool;
+  DeltaStepping engine(csr, pool, 2);
+  std::vector<int> distances;
+  engine.run(csr.index(0), distances);
+  for (int v = 0; v < static_cast<int>(distances.size()); ++v)
+  {
+    std::cout << "v, d: " << csr.id(v) << ", " << distances[v] << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,341 @@
+#ifndef _GRAPHS_DELTASTEPPING_DELTA_STEPPING_H
+#define _GRAPHS_DELTASTEPPING_DELTA_STEPPING_H
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/stats.h"
+#include "../common/thread_pool.h"
+
+// Parallel single source shortest paths for non-negative weights
+// (Meyer and Sanders delta-stepping). Vertices are kept in buckets of
+// width delta by tentative distance and buckets are processed in
+// increasing order. Vertices of the current bucket relax their light
+// edges (weight <= delta) in parallel until the bucket stops refilling,
+// then all vertices settled in the bucket relax their heavy edges in
+// parallel. Distances are updated with atomic min, so every thread
+// works on the same array without locks.
+//
+// Small delta gives Dijkstra-like amount of work with little
+// parallelism, large delta gives Bellman-Ford-like parallelism with
+// repeated relaxations. Distances are exact for any delta.
+//
+// Tentative distances of queued vertices are less than max weight
+// above the current bucket, so buckets live in a cyclic array of
+// ceil(max weight / delta) + 1 slots, and numbers of non-empty buckets
+// are kept in a heap, so empty ones are never visited. Floating point
+// distances get one more slot for rounding of distance / delta.
+template <typename Vertex, typename Weight>
+class DeltaStepping
+{
+public:
+
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Make engine for the graph which runs on threads of the pool.
+  // Delta 0 means to choose it automatically. Delta which needs more
+  // than max_buckets slots is raised to the smallest one which doesn't.
+  DeltaStepping(
+    const BasicCsrGraph<Vertex, Weight>& graph,
+    ThreadPool& pool,
+    Distance delta = 0);
+
+  // Get bucket width.
+  Distance delta() const;
+
+  // Search shortest paths from dense vertex v. Distance of vertex u is
+  // stored in distances[u], unreachable vertices get
+  // Traits::infinity(), same as dijkstra().
+  void run(int v, std::vector<Distance>& distances);
+
+private:
+
+  // Amount of vertices a thread claims at once.
+  static constexpr int grain = 64;
+
+  // Largest amount of slots of the bucket array.
+  static constexpr int max_buckets = 1 << 16;
+
+  // Get number of bucket of distance d.
+  long long bucket(Distance d) const;
+
+  // Put vertex b to bucket k.
+  void push(long long k, int b);
+
+  // Lower distance of b to d. It returns true if d was less.
+  bool relax(int b, Distance d);
+
+  // Relax edges of frontier vertices, light or heavy ones, and record
+  // improved vertices in per-thread requests.
+  void scan(const std::vector<int>& frontier, bool light);
+
+  // Move requested vertices to their buckets. Vertices of the current
+  // bucket go to frontier instead.
+  void merge(long long current, std::vector<int>& frontier);
+
+  const BasicCsrGraph<Vertex, Weight>& graph_;
+
+  ThreadPool& pool_;
+
+  Distance delta_;
+
+  // Tentative distances.
+  std::vector<std::atomic<Distance>> distances_;
+
+  // Bucket k of vertices by distance / delta_ is at slot k % size of
+  // the array. Vertex may be in a bucket which doesn't match its
+  // distance anymore, such entries are skipped.
+  std::vector<std::vector<int>> buckets_;
+
+  // Heap of numbers of non-empty buckets, the smallest on top.
+  std::vector<long long> numbers_;
+
+  // Vertices improved by every thread during the last scan.
+  std::vector<std::vector<int>> requests_;
+
+  // Number of the last frontier vertex was added to, prevents
+  // duplicates in frontiers.
+  std::vector<int> stamp_;
+  int phase_;
+};
+
+template <typename Vertex, typename Weight>
+inline DeltaStepping<Vertex, Weight>::DeltaStepping(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  ThreadPool& pool,
+  Distance delta)
+  : graph_(graph),
+    pool_(pool),
+    delta_(delta),
+    distances_(graph.size()),
+    requests_(pool.size()),
+    stamp_(graph.size(), 0),
+    phase_(0)
+{
+  // Heuristic for random weights: delta of max weight divided by
+  // average degree keeps few vertices reinserted per bucket.
+  const Distance max = std::max<Distance>(graph.max_weight(), 0);
+  const Distance one = 1;
+  auto slots = [&](Distance width)
+  {
+    if constexpr (std::is_floating_point_v<Distance>)
+    {
+      return std::ceil(max / width) + 2;
+    }
+    else
+    {
+      return static_cast<double>((max + width - 1) / width + 1);
+    }
+  };
+
+  if (delta_ <= 0)
+  {
+    const double n = graph.size();
+    const double m = std::max(1, graph.edges());
+    delta_ = std::max(one, static_cast<Distance>(max * (n / m)));
+    delta_ = std::min(delta_, std::max(one, max));
+  }
+  if (slots(delta_) > max_buckets)
+  {
+    if constexpr (std::is_floating_point_v<Distance>)
+    {
+      delta_ = max / (max_buckets - 2);
+    }
+    else
+    {
+      delta_ = (max + max_buckets - 2) / (max_buckets - 1);
+    }
+  }
+  buckets_.resize(slots(delta_));
+}
+
+template <typename Vertex, typename Weight>
+inline typename DeltaStepping<Vertex, Weight>::Distance
+DeltaStepping<Vertex, Weight>::delta() const
+{
+  return delta_;
+}
+
+template <typename Vertex, typename Weight>
+inline long long DeltaStepping<Vertex, Weight>::bucket(Distance d) const
+{
+  if constexpr (std::is_floating_point_v<Distance>)
+  {
+    return static_cast<long long>(d / delta_);
+  }
+  else
+  {
+    return d / delta_;
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline bool DeltaStepping<Vertex, Weight>::relax(int b, Distance d)
+{
+  Distance old = distances_[b].load(std::memory_order_relaxed);
+  while (d < old)
+  {
+    if (distances_[b].compare_exchange_weak(old, d,
+					    std::memory_order_relaxed))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename Vertex, typename Weight>
+inline void DeltaStepping<Vertex, Weight>::scan(
+  const std::vector<int>& frontier, bool light)
+{
+  pool_.for_each_indexed(frontier.size(), grain, [&](unsigned t, int i)
+  {
+    const int u = frontier[i];
+    const Distance du = distances_[u].load(std::memory_order_relaxed);
+    for (int e = graph_.begin(u); e < graph_.end(u); ++e)
+    {
+      const Weight w = graph_.weight(e);
+      if ((w <= delta_) != light)
+      {
+	continue;
+      }
+      GRAPHS_COUNT(relaxations);
+      const int b = graph_.target(e);
+      if (relax(b, Traits::add(du, w)))
+      {
+	requests_[t].push_back(b);
+      }
+    }
+  });
+}
+
+template <typename Vertex, typename Weight>
+inline void DeltaStepping<Vertex, Weight>::push(long long k, int b)
+{
+  auto& slot = buckets_[k % buckets_.size()];
+  if (slot.empty())
+  {
+    numbers_.push_back(k);
+    std::push_heap(numbers_.begin(), numbers_.end(),
+		   std::greater<long long>());
+  }
+  slot.push_back(b);
+  GRAPHS_COUNT(pushes);
+}
+
+template <typename Vertex, typename Weight>
+inline void DeltaStepping<Vertex, Weight>::merge(
+  long long current, std::vector<int>& frontier)
+{
+  ++phase_;
+  for (auto& requests: requests_)
+  {
+    for (const int b: requests)
+    {
+      const long long k =
+	bucket(distances_[b].load(std::memory_order_relaxed));
+      if (k != current)
+      {
+	push(k, b);
+      }
+      else if (stamp_[b] != phase_)
+      {
+	stamp_[b] = phase_;
+	frontier.push_back(b);
+	GRAPHS_COUNT(pushes);
+      }
+    }
+    requests.clear();
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void DeltaStepping<Vertex, Weight>::run(
+  int v, std::vector<Distance>& distances)
+{
+  const int n = graph_.size();
+  for (int u = 0; u < n; ++u)
+  {
+    distances_[u].store(Traits::infinity(), std::memory_order_relaxed);
+  }
+  std::fill(stamp_.begin(), stamp_.end(), 0);
+  phase_ = 0;
+  for (auto& slot: buckets_)
+  {
+    slot.clear();
+  }
+  numbers_.clear();
+
+  distances_[v].store(0, std::memory_order_relaxed);
+  push(0, v);
+
+  std::vector<int> frontier;
+  std::vector<int> settled;
+  while (!numbers_.empty())
+  {
+    std::pop_heap(numbers_.begin(), numbers_.end(),
+		  std::greater<long long>());
+    const long long i = numbers_.back();
+    numbers_.pop_back();
+
+    // Take vertices which still belong to the bucket, without
+    // duplicates. Slot is free for later buckets after that.
+    ++phase_;
+    frontier.clear();
+    auto& slot = buckets_[i % buckets_.size()];
+    for (const int u: slot)
+    {
+      const long long k =
+	bucket(distances_[u].load(std::memory_order_relaxed));
+      if (k == i && stamp_[u] != phase_)
+      {
+	stamp_[u] = phase_;
+	frontier.push_back(u);
+	GRAPHS_COUNT(pops);
+      }
+    }
+    slot.clear();
+
+    // Light edges may put vertices back to the bucket.
+    settled.clear();
+    while (!frontier.empty())
+    {
+      settled.insert(settled.end(), frontier.begin(), frontier.end());
+      scan(frontier, true);
+      frontier.clear();
+      merge(i, frontier);
+    }
+
+    // Distances of the bucket are final, heavy edges lead to later
+    // buckets. Vertex may be settled more than once, its heavy edges
+    // are relaxed once.
+    ++phase_;
+    frontier.clear();
+    for (const int u: settled)
+    {
+      if (stamp_[u] != phase_)
+      {
+	stamp_[u] = phase_;
+	frontier.push_back(u);
+      }
+    }
+    scan(frontier, false);
+    frontier.clear();
+    merge(i, frontier);
+  }
+
+  distances.resize(n);
+  for (int u = 0; u < n; ++u)
+  {
+    distances[u] = distances_[u].load(std::memory_order_relaxed);
+  }
+}
+
+#endif  // _GRAPHS_DELTASTEPPING_DELTA_STEPPING_H
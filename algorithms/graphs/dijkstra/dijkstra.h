@@ -0,0 +1,109 @@
+#ifndef _GRAPHS_DIJKSTRA_DIJKSTRA_H
+#define _GRAPHS_DIJKSTRA_DIJKSTRA_H
+
+#include <vector>
+#include <type_traits>
+#include "../common/graph.h"
+#include "../common/stats.h"
+#include "../common/weights.h"
+#include "queues.h"
+#include "small_weights.h"
+
+// Largest weight for which dijkstra() uses Dial's buckets. Cost of
+// buckets grows with the largest distance, which is at most
+// max_weight times length of the longest shortest path in edges.
+constexpr int dial_max_weight = 255;
+
+// Single source shortest paths from dense vertex v of the graph with
+// non-negative weights. Distance of vertex u is stored in distances[u],
+// unreachable vertices get DistanceTraits<Weight>::infinity(), which is
+// std::numeric_limits<int>::max() for CsrGraph. Queue is the priority
+// queue policy, see queues.h, instantiated for type of distances.
+// Complexity: O(ElogV).
+template <template <typename> class Queue, typename Vertex, typename Weight>
+void dijkstra(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances)
+{
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Initialize distances array.
+  distances.assign(graph.size(), Traits::infinity());
+  distances[v] = 0;
+
+  // Initialize priority queue.
+  Queue<Distance> queue(graph.size());
+  queue.push(v, 0);
+  GRAPHS_COUNT(pushes);
+
+  // Perform relaxation.
+  while (!queue.empty())
+  {
+    const auto [distance, u] = queue.pop();
+    GRAPHS_COUNT(pops);
+    if (distance > distances[u])
+    {
+      continue;
+    }
+
+    for (int e = graph.begin(u); e < graph.end(u); ++e)
+    {
+      GRAPHS_COUNT(relaxations);
+      const int b = graph.target(e);
+      const Distance d = Traits::add(distance, graph.weight(e));
+      if (distances[b] > d)
+      {
+	distances[b] = d;
+	queue.push(b, d);
+	GRAPHS_COUNT(pushes);
+      }
+    }
+  }
+}
+
+// Same as above, with the search picked by range of weights of the
+// graph. For integer weights: BFS if all weights are equal, 0-1 BFS if
+// they are 0 and 1, Dial's buckets if they are small and dijkstra with
+// RadixHeap otherwise. Negative weights, which RadixHeap doesn't allow,
+// and floating point weights are left to LazyHeap. All of them find
+// the same distances.
+template <typename Vertex, typename Weight>
+void dijkstra(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances)
+{
+  if constexpr (std::is_integral_v<Weight>)
+  {
+    const Weight low = graph.min_weight();
+    const Weight high = graph.max_weight();
+    if (low < 0)
+    {
+      dijkstra<LazyHeap>(graph, v, distances);
+    }
+    else if (low == high)
+    {
+      bfs(graph, v, high, distances);
+    }
+    else if (high == 1)
+    {
+      zero_one_bfs(graph, v, distances);
+    }
+    else if (high <= dial_max_weight)
+    {
+      dial(graph, v, high, distances);
+    }
+    else
+    {
+      dijkstra<RadixHeap>(graph, v, distances);
+    }
+  }
+  else
+  {
+    dijkstra<LazyHeap>(graph, v, distances);
+  }
+}
+
+#endif  // _GRAPHS_DIJKSTRA_DIJKSTRA_H
@@ -0,0 +1,273 @@
+#ifndef _GRAPHS_DIJKSTRA_POINT_TO_POINT_H
+#define _GRAPHS_DIJKSTRA_POINT_TO_POINT_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/stats.h"
+
+// Shortest path queries between two vertices of the graph with
+// non-negative weights. Search stops as soon as the target is settled,
+// so scratch arrays are allocated once per finder and only vertices
+// touched by a query are reset after it. All vertices are dense
+// indexes, path is stored as vertices from source to target.
+// Distances are DistanceTraits<Weight>::Distance, see weights.h.
+template <typename Vertex, typename Weight>
+class PathFinder
+{
+public:
+
+  using Graph = BasicCsrGraph<Vertex, Weight>;
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Make finder for the graph.
+  explicit PathFinder(const BasicCsrGraph<Vertex, Weight>& graph);
+
+  // Dijkstra search from s which stops when t is settled. It returns
+  // distance from s to t and stores the path, or returns
+  // Traits::infinity() and clears the path if t is not reachable.
+  Distance search(int s, int t, std::vector<int>& path);
+
+  // A* search. Heuristic h(v) has to be a consistent lower bound of
+  // distance from v to t, that is h(t) = 0 and h(a) <= w + h(b) for
+  // every edge a-(w)->b. Zero heuristic gives plain Dijkstra.
+  template <typename H>
+  Distance search(int s, int t, H heuristic, std::vector<int>& path);
+
+  // Bidirectional Dijkstra: forward search from s and backward search
+  // from t on the reversed graph run alternately and every edge which
+  // reaches vertex labeled by the other side gives a candidate path.
+  // Search stops when sum of minimum keys of both queues reaches
+  // length of the best candidate, no path through unsettled vertices
+  // can be shorter then.
+  Distance bidirectional(int s, int t, std::vector<int>& path);
+
+private:
+
+  using Entry = std::pair<Distance, int>;
+  using Heap = std::vector<Entry>;
+
+  // State of search in one direction.
+  struct Side
+  {
+    // Tentative distances, infinity for untouched vertices.
+    std::vector<Distance> distances;
+
+    // Previous vertex on the path, towards the start of the search.
+    std::vector<int> parents;
+
+    // Vertices whose distance was set.
+    std::vector<int> touched;
+
+    // Queue of (key, vertex) pairs.
+    Heap heap;
+  };
+
+  // Prepare side for a search from v.
+  void start(Side& side, int v);
+
+  // Reset vertices touched by the last search.
+  void reset(Side& side);
+
+  // Set distance and parent of b, push it with key.
+  void label(Side& side, int b, Distance d, int parent, Distance key);
+
+  // Pop entry with the smallest key.
+  static Entry pop(Heap& heap);
+
+  const Graph& graph_;
+
+  // Graph with reversed edges, for backward search.
+  Graph reverse_;
+
+  Side forward_;
+  Side backward_;
+};
+
+template <typename Vertex, typename Weight>
+inline PathFinder<Vertex, Weight>::PathFinder(
+  const BasicCsrGraph<Vertex, Weight>& graph)
+  : graph_(graph), reverse_(graph.reverse())
+{
+  for (Side* side: {&forward_, &backward_})
+  {
+    side->distances.assign(graph.size(), Traits::infinity());
+    side->parents.assign(graph.size(), -1);
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void PathFinder<Vertex, Weight>::reset(Side& side)
+{
+  for (const int v: side.touched)
+  {
+    side.distances[v] = Traits::infinity();
+    side.parents[v] = -1;
+  }
+  side.touched.clear();
+  side.heap.clear();
+}
+
+template <typename Vertex, typename Weight>
+inline void PathFinder<Vertex, Weight>::start(Side& side, int v)
+{
+  reset(side);
+  label(side, v, 0, -1, 0);
+}
+
+template <typename Vertex, typename Weight>
+inline void PathFinder<Vertex, Weight>::label(
+  Side& side, int b, Distance d, int parent, Distance key)
+{
+  if (side.distances[b] == Traits::infinity())
+  {
+    side.touched.push_back(b);
+  }
+  side.distances[b] = d;
+  side.parents[b] = parent;
+  side.heap.emplace_back(key, b);
+  GRAPHS_COUNT(pushes);
+  std::push_heap(side.heap.begin(), side.heap.end(), std::greater<Entry>());
+}
+
+template <typename Vertex, typename Weight>
+inline typename PathFinder<Vertex, Weight>::Entry
+PathFinder<Vertex, Weight>::pop(Heap& heap)
+{
+  std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+  const Entry top = heap.back();
+  heap.pop_back();
+  GRAPHS_COUNT(pops);
+  return top;
+}
+
+template <typename Vertex, typename Weight>
+inline typename PathFinder<Vertex, Weight>::Distance
+PathFinder<Vertex, Weight>::search(int s, int t, std::vector<int>& path)
+{
+  return search(s, t, [](int) { return 0; }, path);
+}
+
+template <typename Vertex, typename Weight>
+template <typename H>
+typename PathFinder<Vertex, Weight>::Distance
+PathFinder<Vertex, Weight>::search(
+  int s, int t, H heuristic, std::vector<int>& path)
+{
+  path.clear();
+  Side& side = forward_;
+  start(side, s);
+
+  while (!side.heap.empty())
+  {
+    const auto [key, u] = pop(side.heap);
+    const Distance du = side.distances[u];
+    if (key > Traits::add(du, heuristic(u)))
+    {
+      continue;
+    }
+
+    if (u == t)
+    {
+      for (int v = t; v != -1; v = side.parents[v])
+      {
+	path.push_back(v);
+      }
+      std::reverse(path.begin(), path.end());
+      return du;
+    }
+
+    for (int e = graph_.begin(u); e < graph_.end(u); ++e)
+    {
+      const int b = graph_.target(e);
+      GRAPHS_COUNT(relaxations);
+      const Distance d = Traits::add(du, graph_.weight(e));
+      if (side.distances[b] > d)
+      {
+	label(side, b, d, u, Traits::add(d, heuristic(b)));
+      }
+    }
+  }
+  return Traits::infinity();
+}
+
+template <typename Vertex, typename Weight>
+inline typename PathFinder<Vertex, Weight>::Distance
+PathFinder<Vertex, Weight>::bidirectional(
+  int s, int t, std::vector<int>& path)
+{
+  path.clear();
+  start(forward_, s);
+  start(backward_, t);
+
+  // Length of the best path found so far and its middle vertex.
+  Distance best = s == t ? 0 : Traits::infinity();
+  int middle = s == t ? s : -1;
+
+  while (!forward_.heap.empty() && !backward_.heap.empty())
+  {
+    const Distance bound = Traits::add(forward_.heap.front().first,
+				       backward_.heap.front().first);
+    if (bound >= best)
+    {
+      break;
+    }
+
+    // Advance the side with the smaller queue.
+    const bool ahead = forward_.heap.size() <= backward_.heap.size();
+    Side& side = ahead ? forward_ : backward_;
+    const Side& other = ahead ? backward_ : forward_;
+    const Graph& graph = ahead ? graph_ : reverse_;
+
+    const auto [key, u] = pop(side.heap);
+    if (key > side.distances[u])
+    {
+      continue;
+    }
+
+    for (int e = graph.begin(u); e < graph.end(u); ++e)
+    {
+      const int b = graph.target(e);
+      GRAPHS_COUNT(relaxations);
+      const Distance d = Traits::add(key, graph.weight(e));
+      if (side.distances[b] > d)
+      {
+	label(side, b, d, u, d);
+      }
+
+      // Parents of both sides lead from b to s and t, so candidate
+      // has to use the current distances of b.
+      const Distance db = side.distances[b];
+      if (other.distances[b] != Traits::infinity()
+	  && Traits::add(db, other.distances[b]) < best)
+      {
+	best = Traits::add(db, other.distances[b]);
+	middle = b;
+      }
+    }
+  }
+
+  if (middle == -1)
+  {
+    return Traits::infinity();
+  }
+
+  // Forward parents lead from middle to s, backward ones to t.
+  for (int v = middle; v != -1; v = forward_.parents[v])
+  {
+    path.push_back(v);
+  }
+  std::reverse(path.begin(), path.end());
+  for (int v = backward_.parents[middle]; v != -1; v = backward_.parents[v])
+  {
+    path.push_back(v);
+  }
+  return best;
+}
+
+#endif  // _GRAPHS_DIJKSTRA_POINT_TO_POINT_H
@@ -0,0 +1,315 @@
+#ifndef _GRAPHS_DIJKSTRA_QUEUES_H
+#define _GRAPHS_DIJKSTRA_QUEUES_H
+
+#include <queue>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+// Priority queues of vertices keyed by tentative distance, used as
+// queue policy of dijkstra(). Queues are templates over type of
+// distances D. Every queue is made for a graph of n vertices and
+// supports:
+//
+//   push(v, d) - insert vertex v with distance d, or lower its
+//                distance to d if it's already queued;
+//   pop()      - remove entry with the smallest distance and return it
+//                as (distance, vertex) pair;
+//   empty()    - check whether queue is empty.
+//
+// Queues without decrease-key may return stale entries (distance
+// greater than the current one), callers have to skip them.
+
+// Binary heap of (distance, vertex) pairs. Every push adds a new
+// entry, so heap grows to O(E) and pop returns stale entries.
+template <typename D = int>
+class LazyHeap
+{
+public:
+
+  // Make empty queue for graph of n vertices.
+  explicit LazyHeap(int n);
+
+  void push(int v, D d);
+  std::pair<D, int> pop();
+  bool empty() const;
+
+private:
+
+  using T = std::pair<D, int>;
+  std::priority_queue<T, std::vector<T>, std::greater<T>> heap_;
+};
+
+template <typename D>
+inline LazyHeap<D>::LazyHeap(int)
+{
+}
+
+template <typename D>
+inline void LazyHeap<D>::push(int v, D d)
+{
+  heap_.emplace(d, v);
+}
+
+template <typename D>
+inline std::pair<D, int> LazyHeap<D>::pop()
+{
+  const auto top = heap_.top();
+  heap_.pop();
+  return top;
+}
+
+template <typename D>
+inline bool LazyHeap<D>::empty() const
+{
+  return heap_.empty();
+}
+
+// Indexed 4-ary heap with decrease-key. Position of every queued
+// vertex is tracked, so every vertex has at most one entry, heap size
+// is bounded by V and pop never returns stale entries. 4-ary layout
+// makes the heap shallower than binary one and children of a node
+// share a cache line.
+template <typename D = int>
+class IndexedHeap
+{
+public:
+
+  // Make empty queue for graph of n vertices.
+  explicit IndexedHeap(int n);
+
+  void push(int v, D d);
+  std::pair<D, int> pop();
+  bool empty() const;
+
+private:
+
+  static constexpr int arity = 4;
+
+  // Move entry at position i up until heap order is restored.
+  void sift_up(int i);
+
+  // Move entry at position i down until heap order is restored.
+  void sift_down(int i);
+
+  // Put entry to position i and update position of its vertex.
+  void place(int i, const std::pair<D, int>& entry);
+
+  // Heap of (distance, vertex) pairs.
+  std::vector<std::pair<D, int>> heap_;
+
+  // Position of vertex in the heap, -1 if it's not queued.
+  std::vector<int> pos_;
+};
+
+template <typename D>
+inline IndexedHeap<D>::IndexedHeap(int n)
+  : pos_(n, -1)
+{
+}
+
+template <typename D>
+inline void IndexedHeap<D>::place(int i, const std::pair<D, int>& entry)
+{
+  heap_[i] = entry;
+  pos_[entry.second] = i;
+}
+
+template <typename D>
+inline void IndexedHeap<D>::sift_up(int i)
+{
+  const auto entry = heap_[i];
+  while (i > 0)
+  {
+    const int parent = (i - 1) / arity;
+    if (heap_[parent].first <= entry.first)
+    {
+      break;
+    }
+    place(i, heap_[parent]);
+    i = parent;
+  }
+  place(i, entry);
+}
+
+template <typename D>
+inline void IndexedHeap<D>::sift_down(int i)
+{
+  const int n = heap_.size();
+  const auto entry = heap_[i];
+  for (;;)
+  {
+    const int first = i * arity + 1;
+    if (first >= n)
+    {
+      break;
+    }
+
+    // Find the smallest child.
+    int child = first;
+    const int last = std::min(first + arity, n);
+    for (int c = first + 1; c < last; ++c)
+    {
+      if (heap_[c].first < heap_[child].first)
+      {
+	child = c;
+      }
+    }
+
+    if (heap_[child].first >= entry.first)
+    {
+      break;
+    }
+    place(i, heap_[child]);
+    i = child;
+  }
+  place(i, entry);
+}
+
+template <typename D>
+inline void IndexedHeap<D>::push(int v, D d)
+{
+  int i = pos_[v];
+  if (i == -1)
+  {
+    i = heap_.size();
+    heap_.emplace_back(d, v);
+  }
+  else if (d < heap_[i].first)
+  {
+    heap_[i].first = d;
+  }
+  else
+  {
+    return;
+  }
+  sift_up(i);
+}
+
+template <typename D>
+inline std::pair<D, int> IndexedHeap<D>::pop()
+{
+  const auto top = heap_.front();
+  pos_[top.second] = -1;
+
+  const auto last = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty())
+  {
+    heap_.front() = last;
+    sift_down(0);
+  }
+  return top;
+}
+
+template <typename D>
+inline bool IndexedHeap<D>::empty() const
+{
+  return heap_.empty();
+}
+
+// Radix heap for non-negative integer distances. It relies on the
+// monotonicity of Dijkstra: distance of pushed vertex is never less
+// than the last popped one. Entry goes to bucket number of the highest
+// bit in which its distance differs from the last popped distance, so
+// entry is moved between buckets at most once per bit of D and pop is
+// amortized O(log C) without comparisons. Like LazyHeap it returns
+// stale entries.
+template <typename D = int>
+class RadixHeap
+{
+  static_assert(std::is_integral_v<D> && sizeof(D) <= 8,
+		"radix heap needs integer distances");
+
+public:
+
+  // Make empty queue for graph of n vertices.
+  explicit RadixHeap(int n);
+
+  void push(int v, D d);
+  std::pair<D, int> pop();
+  bool empty() const;
+
+private:
+
+  using Unsigned = std::make_unsigned_t<D>;
+
+  static constexpr int buckets = 8 * sizeof(D) + 1;
+
+  // Get bucket of distance d.
+  int bucket(Unsigned d) const;
+
+  // Buckets of (distance, vertex) pairs.
+  std::vector<std::pair<D, int>> buckets_[buckets];
+
+  // The last popped distance.
+  Unsigned last_;
+
+  // Amount of entries in all buckets.
+  std::size_t size_;
+};
+
+template <typename D>
+inline RadixHeap<D>::RadixHeap(int)
+  : last_(0), size_(0)
+{
+}
+
+template <typename D>
+inline int RadixHeap<D>::bucket(Unsigned d) const
+{
+  const std::uint64_t bits = d ^ last_;
+  return bits == 0 ? 0 : 64 - __builtin_clzll(bits);
+}
+
+template <typename D>
+inline void RadixHeap<D>::push(int v, D d)
+{
+  buckets_[bucket(d)].emplace_back(d, v);
+  ++size_;
+}
+
+template <typename D>
+inline std::pair<D, int> RadixHeap<D>::pop()
+{
+  // Refill the first bucket from the first non-empty one. All its
+  // entries move to lower buckets since new last_ is their minimum.
+  if (buckets_[0].empty())
+  {
+    int i = 1;
+    while (buckets_[i].empty())
+    {
+      ++i;
+    }
+
+    Unsigned min = buckets_[i].front().first;
+    for (const auto& entry: buckets_[i])
+    {
+      min = std::min(min, static_cast<Unsigned>(entry.first));
+    }
+    last_ = min;
+
+    for (const auto& entry: buckets_[i])
+    {
+      buckets_[bucket(entry.first)].push_back(entry);
+    }
+    buckets_[i].clear();
+  }
+
+  const auto top = buckets_[0].back();
+  buckets_[0].pop_back();
+  --size_;
+  return top;
+}
+
+template <typename D>
+inline bool RadixHeap<D>::empty() const
+{
+  return size_ == 0;
+}
+
+#endif  // _GRAPHS_DIJKSTRA_QUEUES_H
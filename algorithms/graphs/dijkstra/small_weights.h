@@ -0,0 +1,171 @@
+#ifndef _GRAPHS_DIJKSTRA_SMALL_WEIGHTS_H
+#define _GRAPHS_DIJKSTRA_SMALL_WEIGHTS_H
+
+#include <deque>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include "../common/graph.h"
+#include "../common/stats.h"
+#include "../common/weights.h"
+
+// Single source shortest paths for graphs with small non-negative
+// integer weights, where a priority queue can be replaced by a plain
+// one. Every search has the same contract as dijkstra(): distances
+// from dense vertex v, DistanceTraits<Weight>::infinity() for
+// unreachable vertices. Caller guarantees the range of weights, see
+// BasicCsrGraph::min_weight and BasicCsrGraph::max_weight.
+
+// Breadth first search for graph with all weights equal to w. Vertex
+// is final once it's discovered, distance is w times its level.
+// Complexity: O(V + E).
+template <typename Vertex, typename Weight>
+void bfs(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  const Weight w,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances)
+{
+  using Traits = DistanceTraits<Weight>;
+  distances.assign(graph.size(), Traits::infinity());
+  distances[v] = 0;
+
+  // Queue of discovered vertices, in order of their distances.
+  std::vector<int> queue;
+  queue.reserve(graph.size());
+  queue.push_back(v);
+  GRAPHS_COUNT(pushes);
+
+  for (std::size_t i = 0; i < queue.size(); ++i)
+  {
+    const int u = queue[i];
+    GRAPHS_COUNT(pops);
+    const auto d = Traits::add(distances[u], w);
+    for (int e = graph.begin(u); e < graph.end(u); ++e)
+    {
+      GRAPHS_COUNT(relaxations);
+      const int b = graph.target(e);
+      if (distances[b] > d)
+      {
+	distances[b] = d;
+	queue.push_back(b);
+	GRAPHS_COUNT(pushes);
+      }
+    }
+  }
+}
+
+// 0-1 BFS for graph with weights 0 and 1. Deque holds entries of at
+// most two distances d and d + 1 in order: vertex reached by 0 edge
+// goes to the front, by 1 edge to the back. Stale entries are skipped
+// as in LazyHeap. Complexity: O(V + E).
+template <typename Vertex, typename Weight>
+void zero_one_bfs(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances)
+{
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+  distances.assign(graph.size(), Traits::infinity());
+  distances[v] = 0;
+
+  // Entries of (distance, vertex).
+  std::deque<std::pair<Distance, int>> queue;
+  queue.emplace_back(0, v);
+  GRAPHS_COUNT(pushes);
+
+  while (!queue.empty())
+  {
+    const auto [distance, u] = queue.front();
+    queue.pop_front();
+    GRAPHS_COUNT(pops);
+    if (distance > distances[u])
+    {
+      continue;
+    }
+
+    for (int e = graph.begin(u); e < graph.end(u); ++e)
+    {
+      GRAPHS_COUNT(relaxations);
+      const int b = graph.target(e);
+      const Weight w = graph.weight(e);
+      const Distance d = Traits::add(distance, w);
+      if (distances[b] > d)
+      {
+	distances[b] = d;
+	if (w == 0)
+	{
+	  queue.emplace_front(d, b);
+	}
+	else
+	{
+	  queue.emplace_back(d, b);
+	}
+	GRAPHS_COUNT(pushes);
+      }
+    }
+  }
+}
+
+// Dial's algorithm for graph with weights in [0, max_weight]. Queued
+// distances are within [d, d + max_weight] of the current distance d,
+// so max_weight + 1 buckets indexed by distance modulo their amount
+// make a circular bucket queue. Bucket keeps vertices of one
+// distance, stale entries are skipped. Complexity: O(E + D), where D
+// is the largest distance, as every distance up to it is visited.
+template <typename Vertex, typename Weight>
+void dial(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const int v,
+  const int max_weight,
+  std::vector<typename DistanceTraits<Weight>::Distance>& distances)
+{
+  static_assert(std::is_integral_v<Weight>, "Dial needs integer weights");
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+  distances.assign(graph.size(), Traits::infinity());
+  distances[v] = 0;
+
+  const int count = max_weight + 1;
+  std::vector<std::vector<int>> buckets(count);
+  buckets[0].push_back(v);
+  GRAPHS_COUNT(pushes);
+  long long queued = 1;
+
+  Distance d = 0;
+  for (int k = 0; queued != 0; ++d, k = k + 1 == count ? 0 : k + 1)
+  {
+    // Edges of weight 0 append to the current bucket, so its size is
+    // checked on every step.
+    for (std::size_t i = 0; i < buckets[k].size(); ++i)
+    {
+      const int u = buckets[k][i];
+      GRAPHS_COUNT(pops);
+      if (distances[u] != d)
+      {
+	continue;
+      }
+
+      for (int e = graph.begin(u); e < graph.end(u); ++e)
+      {
+	GRAPHS_COUNT(relaxations);
+	const int b = graph.target(e);
+	const int w = graph.weight(e);
+	const Distance next = Traits::add(d, w);
+	if (distances[b] > next)
+	{
+	  distances[b] = next;
+	  const int r = k + w < count ? k + w : k + w - count;
+	  buckets[r].push_back(b);
+	  GRAPHS_COUNT(pushes);
+	  ++queued;
+	}
+      }
+    }
+    queued -= buckets[k].size();
+    buckets[k].clear();
+  }
+}
+
+#endif  // _GRAPHS_DIJKSTRA_SMALL_WEIGHTS_H
@@ -0,0 +1,47 @@
+
+#include <vector>
+#include <iostream>
+#include "dynamic_paths.h"
+
+// Print distances and paths of all vertices.
+template <typename Vertex, typename Weight>
+void print(const DynamicPaths<Vertex, Weight>& paths)
+{
+  for (int v = 0; v < paths.size(); ++v)
+  {
+    std::cout << "v, d, path: " << paths.id(v) << ", " << paths.distance(v)
+	      << ",";
+    for (const int u: paths.path(v))
+    {
+      std::cout << " " << paths.id(u);
+    }
+    std::cout << "\n";
+  }
+}
+
+int main()
+{
+
+  // 0----(4)---->1----(3)---->3
+  // |            ^
+  // |            |
+  // |           (2)
+  // |            |
+  // +----(1)---->2
+  Graph graph;
+  graph.add_edge(0, 1, 4);
+  graph.add_edge(0, 2, 1);
+  graph.add_edge(2, 1, 2);
+  graph.add_edge(1, 3, 3);
+  const CsrGraph csr = graph.freeze();
+  DynamicPaths paths(csr, csr.index(0));
+  print(paths);
+
+  // Shortcut 2-(1)->3, new vertex 4 behind 3 and 0-(4)->1 lowered to 1.
+  paths.add_edge(2, 3, 1);
+  paths.add_edge(3, 4, 5);
+  paths.decrease_weight(0, 1, 1);
+  std::cout << "changed: " << paths.update() << "\n";
+  print(paths);
+  return 0;
+}
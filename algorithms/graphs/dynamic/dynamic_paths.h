@@ -0,0 +1,306 @@
+#ifndef _GRAPHS_DYNAMIC_DYNAMIC_PATHS_H
+#define _GRAPHS_DYNAMIC_DYNAMIC_PATHS_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/stats.h"
+#include "../dijkstra/queues.h"
+
+// Shortest paths from one source maintained under edge insertions and
+// weight decreases, in the manner of Ramalingam and Reps. Both kinds
+// of updates can only shorten paths, so a distance is never raised and
+// shortest path tree changes only below vertices whose distance drops.
+//
+// Updates are batched: every update relaxes its edge at once and, if
+// the target gets shorter distance, queues the target. update() then
+// runs Dijkstra seeded with the queued vertices over the current
+// distances, so it stops at vertices whose distance doesn't change.
+// Every changed vertex is settled once per batch and scans its out
+// edges, so cost of a batch is O(D log D) for D edges of changed
+// vertices, independent of size of the graph.
+//
+// Graph is kept as adjacency lists over dense indexes. Vertices of the
+// initial graph keep their indexes, new vertex ids get indexes in
+// order of appearance. Weights must be non-negative.
+template <typename Vertex, typename Weight>
+class DynamicPaths
+{
+public:
+
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Find shortest paths from dense vertex v of the graph. The graph is
+  // copied and isn't used afterwards.
+  DynamicPaths(const BasicCsrGraph<Vertex, Weight>& graph, int v);
+
+  // Insert edge a-(w)->b of vertex ids, unknown ids become new
+  // vertices. Takes effect at the next update().
+  void add_edge(Vertex a, Vertex b, Weight w);
+
+  // Lower weight of edges a->b of vertex ids to w, edges of smaller
+  // weight are left as they are. Takes effect at the next update().
+  // Returns false if there is no edge a->b.
+  bool decrease_weight(Vertex a, Vertex b, Weight w);
+
+  // Repair distances and shortest path tree after updates since the
+  // previous call. Returns amount of vertices whose distance changed.
+  int update();
+
+  // Insert edges of the batch and repair distances, same as add_edge
+  // for every edge followed by update().
+  int update(const std::vector<BasicEdge<Vertex, Weight>>& edges);
+
+  // Get amount of vertices.
+  int size() const;
+
+  // Get dense index of vertex id, -1 if there is no such vertex.
+  int index(Vertex id) const;
+
+  // Get vertex id of dense index v.
+  Vertex id(int v) const;
+
+  // Get distance of dense vertex v, Traits::infinity() if it's
+  // unreachable.
+  Distance distance(int v) const;
+
+  // Get distances of all vertices by dense indexes.
+  const std::vector<Distance>& distances() const;
+
+  // Get parent of dense vertex v in shortest path tree, -1 for the
+  // source and unreachable vertices.
+  int parent(int v) const;
+
+  // Get shortest path from the source to dense vertex v, empty if v is
+  // unreachable.
+  std::vector<int> path(int v) const;
+
+private:
+
+  // Out edge of a vertex.
+  struct Arc
+  {
+    int target;
+    Weight weight;
+  };
+
+  // Get dense index of vertex id, adding new vertex if there is none.
+  int add_vertex(Vertex id);
+
+  // Relax edge a-(w)->b: if path through a is shorter than distance
+  // of b, lower the distance and queue b.
+  void relax(int a, int b, Weight w);
+
+  // Out edges of vertices.
+  std::vector<std::vector<Arc>> arcs_;
+
+  // Vertex ids of dense indexes and their inverse.
+  std::vector<Vertex> ids_;
+  std::unordered_map<Vertex, int> indexes_;
+
+  // Distances and shortest path tree.
+  std::vector<Distance> distances_;
+  std::vector<int> parents_;
+
+  // Vertices whose distance dropped since the last update().
+  LazyHeap<Distance> queue_;
+};
+
+template <typename Vertex, typename Weight>
+inline DynamicPaths<Vertex, Weight>::DynamicPaths(
+  const BasicCsrGraph<Vertex, Weight>& graph, int v)
+  : arcs_(graph.size()),
+    ids_(graph.size()),
+    distances_(graph.size(), Traits::infinity()),
+    parents_(graph.size(), -1),
+    queue_(graph.size())
+{
+  for (int a = 0; a < graph.size(); ++a)
+  {
+    ids_[a] = graph.id(a);
+    indexes_[ids_[a]] = a;
+    arcs_[a].reserve(graph.end(a) - graph.begin(a));
+    for (int e = graph.begin(a); e < graph.end(a); ++e)
+    {
+      arcs_[a].push_back({graph.target(e), graph.weight(e)});
+    }
+  }
+
+  // Initial search is a repair of the graph where only the source is
+  // reachable.
+  distances_[v] = 0;
+  queue_.push(v, 0);
+  GRAPHS_COUNT(pushes);
+  update();
+}
+
+template <typename Vertex, typename Weight>
+inline int DynamicPaths<Vertex, Weight>::add_vertex(Vertex id)
+{
+  const auto [it, added] = indexes_.emplace(id, ids_.size());
+  if (added)
+  {
+    ids_.push_back(id);
+    arcs_.emplace_back();
+    distances_.push_back(Traits::infinity());
+    parents_.push_back(-1);
+  }
+  return it->second;
+}
+
+template <typename Vertex, typename Weight>
+inline void DynamicPaths<Vertex, Weight>::relax(int a, int b, Weight w)
+{
+  if (distances_[a] == Traits::infinity())
+  {
+    return;
+  }
+  const Distance d = Traits::add(distances_[a], w);
+  if (d < distances_[b])
+  {
+    distances_[b] = d;
+    parents_[b] = a;
+    queue_.push(b, d);
+    GRAPHS_COUNT(pushes);
+  }
+}
+
+template <typename Vertex, typename Weight>
+inline void DynamicPaths<Vertex, Weight>::add_edge(
+  Vertex a, Vertex b, Weight w)
+{
+  const int u = add_vertex(a);
+  const int v = add_vertex(b);
+  arcs_[u].push_back({v, w});
+  relax(u, v, w);
+}
+
+template <typename Vertex, typename Weight>
+inline bool DynamicPaths<Vertex, Weight>::decrease_weight(
+  Vertex a, Vertex b, Weight w)
+{
+  const int u = index(a);
+  const int v = index(b);
+  if (u == -1 || v == -1)
+  {
+    return false;
+  }
+
+  bool found = false;
+  for (auto& arc: arcs_[u])
+  {
+    if (arc.target == v)
+    {
+      arc.weight = std::min(arc.weight, w);
+      found = true;
+    }
+  }
+  if (found)
+  {
+    relax(u, v, w);
+  }
+  return found;
+}
+
+template <typename Vertex, typename Weight>
+inline int DynamicPaths<Vertex, Weight>::update()
+{
+  // Dijkstra over the current distances. Vertex may be queued several
+  // times in a batch, every time with smaller distance, and settles
+  // with the last one.
+  int changed = 0;
+  while (!queue_.empty())
+  {
+    const auto [distance, u] = queue_.pop();
+    GRAPHS_COUNT(pops);
+    if (distance > distances_[u])
+    {
+      continue;
+    }
+    ++changed;
+
+    for (const auto& arc: arcs_[u])
+    {
+      GRAPHS_COUNT(relaxations);
+      relax(u, arc.target, arc.weight);
+    }
+  }
+  return changed;
+}
+
+template <typename Vertex, typename Weight>
+inline int DynamicPaths<Vertex, Weight>::update(
+  const std::vector<BasicEdge<Vertex, Weight>>& edges)
+{
+  for (const auto& edge: edges)
+  {
+    add_edge(edge.a, edge.b, edge.w);
+  }
+  return update();
+}
+
+template <typename Vertex, typename Weight>
+inline int DynamicPaths<Vertex, Weight>::size() const
+{
+  return ids_.size();
+}
+
+template <typename Vertex, typename Weight>
+inline int DynamicPaths<Vertex, Weight>::index(Vertex id) const
+{
+  const auto it = indexes_.find(id);
+  if (it == indexes_.cend())
+  {
+    return -1;
+  }
+  return it->second;
+}
+
+template <typename Vertex, typename Weight>
+inline Vertex DynamicPaths<Vertex, Weight>::id(int v) const
+{
+  return ids_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline typename DynamicPaths<Vertex, Weight>::Distance
+DynamicPaths<Vertex, Weight>::distance(int v) const
+{
+  return distances_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline const std::vector<typename DynamicPaths<Vertex, Weight>::Distance>&
+DynamicPaths<Vertex, Weight>::distances() const
+{
+  return distances_;
+}
+
+template <typename Vertex, typename Weight>
+inline int DynamicPaths<Vertex, Weight>::parent(int v) const
+{
+  return parents_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline std::vector<int> DynamicPaths<Vertex, Weight>::path(int v) const
+{
+  std::vector<int> path;
+  if (distances_[v] == Traits::infinity())
+  {
+    return path;
+  }
+  for (; v != -1; v = parents_[v])
+  {
+    path.push_back(v);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+#endif  // _GRAPHS_DYNAMIC_DYNAMIC_PATHS_H
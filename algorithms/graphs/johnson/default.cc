@@ -0,0 +1,48 @@
+
+#include <vector>
+#include <limits>
+#include <iostream>
+#include "johnson.h"
+
+int main()
+{
+
+  // 0----(4)---->1----(3)---->3
+  // |            ^            |
+  // |            |            |
+  // |           (2)          (-1)
+  // |            |            |
+  // +----(1)---->2<-----------+
+  Graph graph;
+  graph.add_edge(0, 1, 4);
+  graph.add_edge(0, 2, 1);
+  graph.add_edge(2, 1, 2);
+  graph.add_edge(1, 3, 3);
+  graph.add_edge(3, 2, -1);
+  const CsrGraph csr = graph.freeze();
+  ThreadPool pool;
+  DistanceMatrix<int> matrix;
+  if (!matrix.create(csr.size(), "example.apsp")
+      || !johnson(csr, pool, matrix))
+  {
+    return 1;
+  }
+
+  for (int s = 0; s < csr.size(); ++s)
+  {
+    for (int t = 0; t < csr.size(); ++t)
+    {
+      const int d = matrix.at(s, t);
+      std::cout << "s, t, d: " << csr.id(s) << ", " << csr.id(t) << ", ";
+      if (d == std::numeric_limits<int>::max())
+      {
+	std::cout << "inf\n";
+      }
+      else
+      {
+	std::cout << d << "\n";
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,348 @@
+#ifndef _GRAPHS_JOHNSON_JOHNSON_H
+#define _GRAPHS_JOHNSON_JOHNSON_H
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <type_traits>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/thread_pool.h"
+#include "../dijkstra/dijkstra.h"
+#include "../bellmanford/bellman_ford.h"
+
+// Header of distance matrix file. Tiles of the matrix follow it. Type
+// of distances is its size, whether it's floating point and whether
+// it's signed, as size * 4 + floating * 2 + signed.
+struct MatrixHeader
+{
+  char magic[8];
+  std::int64_t vertices;
+  std::int64_t tile;
+  std::int64_t type;
+
+  // Header takes a cache line, so tiles are aligned to cache lines.
+  char reserved[32];
+};
+
+constexpr char matrix_magic[8] = {'A', 'P', 'S', 'P', 'M', 'A', 'T', '2'};
+
+// Matrix of distances between all pairs of n vertices. Matrix is cut
+// into square tiles of tile x tile distances, tiles are stored row by
+// row and distances of a tile are stored row by row too. Distances of
+// nearby pairs share tiles and so pages and cache lines, no matter
+// whether they are close in the same row or in the same column. Rows
+// and columns are padded to a multiple of tile.
+//
+// Matrix lives either in memory or in a file mapped into memory, for
+// matrices larger than memory. Distances are of type Distance, which
+// is DistanceTraits<Weight>::Distance of the graph.
+template <typename Distance>
+class DistanceMatrix
+{
+public:
+
+  // Side of tile, a row of tile of int distances takes 4 cache lines.
+  static constexpr int tile = 64;
+
+  // Make empty matrix.
+  DistanceMatrix();
+
+  // Make matrix of n vertices in memory.
+  void allocate(int n);
+
+  // Make matrix of n vertices in file fname mapped into memory. File
+  // is created or truncated, it starts with MatrixHeader.
+  bool map(const char* fname, int n);
+
+  // Make matrix of n vertices in memory if it takes at most half of
+  // physical memory, otherwise in file fname. Returns false if there
+  // is no file or it can't be mapped.
+  bool create(int n, const char* fname);
+
+  // Get amount of vertices.
+  int size() const;
+
+  // Get distance from dense vertex s to dense vertex t.
+  Distance at(int s, int t) const;
+
+  // Store distances from dense vertex s to all vertices.
+  void set_row(int s, const std::vector<Distance>& distances);
+
+  // Get amount of bytes of distances of matrix of n vertices.
+  static std::size_t bytes(int n);
+
+private:
+
+  // Get position of distance from s to t.
+  std::size_t offset(int s, int t) const;
+
+  int n_;
+
+  // Amount of tiles in a row.
+  std::size_t tiles_;
+
+  // Distances, owned by the matrix or the mapping.
+  std::shared_ptr<Distance> data_;
+};
+
+template <typename Distance>
+inline DistanceMatrix<Distance>::DistanceMatrix()
+  : n_(0), tiles_(0)
+{
+}
+
+template <typename Distance>
+inline std::size_t DistanceMatrix<Distance>::bytes(int n)
+{
+  const std::size_t side = (static_cast<std::size_t>(n) + tile - 1) / tile;
+  return side * side * tile * tile * sizeof(Distance);
+}
+
+template <typename Distance>
+inline void DistanceMatrix<Distance>::allocate(int n)
+{
+  n_ = n;
+  tiles_ = (static_cast<std::size_t>(n) + tile - 1) / tile;
+  const auto storage =
+    std::make_shared<std::vector<Distance>>(bytes(n) / sizeof(Distance));
+  data_ = std::shared_ptr<Distance>(storage, storage->data());
+}
+
+template <typename Distance>
+inline bool DistanceMatrix<Distance>::map(const char* fname, int n)
+{
+  const int fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1)
+  {
+    std::cerr << __func__ << ": can't open " << fname << ": "
+	      << strerror(errno) << "\n";
+    return false;
+  }
+
+  const std::size_t size = sizeof(MatrixHeader) + bytes(n);
+  if (ftruncate(fd, size) == -1)
+  {
+    std::cerr << __func__ << ": ftruncate error: " << strerror(errno)
+	      << "\n";
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    std::cerr << __func__ << ": mmap error: " << strerror(errno) << "\n";
+    return false;
+  }
+
+  MatrixHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, matrix_magic, sizeof(header.magic));
+  header.vertices = n;
+  header.tile = tile;
+  header.type = sizeof(Distance) * 4
+    + std::is_floating_point_v<Distance> * 2 + std::is_signed_v<Distance>;
+  memcpy(data, &header, sizeof(header));
+
+  n_ = n;
+  tiles_ = (static_cast<std::size_t>(n) + tile - 1) / tile;
+  Distance* distances = reinterpret_cast<Distance*>(
+    static_cast<char*>(data) + sizeof(header));
+  data_ = std::shared_ptr<Distance>(distances, [data, size](Distance*)
+  {
+    munmap(data, size);
+  });
+  return true;
+}
+
+template <typename Distance>
+inline bool DistanceMatrix<Distance>::create(int n, const char* fname)
+{
+  const std::size_t memory = static_cast<std::size_t>(
+    sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+  if (bytes(n) <= memory / 2)
+  {
+    allocate(n);
+    return true;
+  }
+  if (fname == nullptr)
+  {
+    std::cerr << __func__ << ": matrix of " << bytes(n)
+	      << " bytes needs a file\n";
+    return false;
+  }
+  return map(fname, n);
+}
+
+template <typename Distance>
+inline int DistanceMatrix<Distance>::size() const
+{
+  return n_;
+}
+
+template <typename Distance>
+inline std::size_t DistanceMatrix<Distance>::offset(int s, int t) const
+{
+  const std::size_t row = s / tile;
+  const std::size_t column = t / tile;
+  return ((row * tiles_ + column) * tile + s % tile) * tile + t % tile;
+}
+
+template <typename Distance>
+inline Distance DistanceMatrix<Distance>::at(int s, int t) const
+{
+  return data_.get()[offset(s, t)];
+}
+
+template <typename Distance>
+inline void DistanceMatrix<Distance>::set_row(
+  int s, const std::vector<Distance>& distances)
+{
+  // Row of a tile is contiguous, so row of the matrix is written by
+  // pieces of tile distances.
+  for (int t = 0; t < n_; t += tile)
+  {
+    const int count = std::min(tile, n_ - t);
+    std::copy(distances.cbegin() + t, distances.cbegin() + t + count,
+	      data_.get() + offset(s, t));
+  }
+}
+
+// Type of potentials and reweighted weights of graph with weights of
+// type Weight: long long for integers, as distances to the virtual
+// source may not fit the weight type, and double for floating point.
+template <typename Weight>
+using Potential = std::conditional_t<
+  std::is_floating_point_v<Weight>, double, long long>;
+
+// Find potentials of vertices for Johnson's reweighting: distances
+// from a virtual source with edges of weight 0 to all vertices,
+// found by bellman_ford(). For every edge a-(w)->b of the graph
+// w + h(a) - h(b) >= 0. Returns false if the graph has a negative
+// cycle. Potentials of graph without negative weights are 0.
+template <typename Vertex, typename Weight>
+inline bool find_potentials(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  std::vector<Potential<Weight>>& h)
+{
+  const int n = graph.size();
+  const int m = graph.edges();
+  h.assign(n, 0);
+  if (graph.min_weight() >= 0)
+  {
+    return true;
+  }
+
+  // Graph with virtual source n. Its ids are dense indexes of the
+  // graph, every vertex is an end of edge from the source, so dense
+  // indexes stay the same.
+  using WideGraph = BasicCsrGraph<int, Potential<Weight>>;
+  std::vector<typename WideGraph::EdgeType> edges;
+  edges.reserve(m + n);
+  for (int a = 0; a < n; ++a)
+  {
+    for (int e = graph.begin(a); e < graph.end(a); ++e)
+    {
+      edges.push_back({a, graph.target(e), graph.weight(e)});
+    }
+  }
+  for (int v = 0; v < n; ++v)
+  {
+    edges.push_back({n, v, 0});
+  }
+
+  const WideGraph augmented = WideGraph::build(edges);
+  std::vector<Potential<Weight>> distances;
+  bellman_ford(augmented, n, distances);
+  if (distances.empty())
+  {
+    return false;
+  }
+  std::copy(distances.cbegin(), distances.cbegin() + n, h.begin());
+  return true;
+}
+
+// Make graph of the same structure with weights w + h(a) - h(b), which
+// are non-negative for potentials found by find_potentials. Weights
+// are Potential<Weight>, so they don't overflow for any int weights.
+template <typename Vertex, typename Weight>
+inline BasicCsrGraph<Vertex, Potential<Weight>> reweight(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  const std::vector<Potential<Weight>>& h)
+{
+  return graph.template with_weights<Potential<Weight>>([&](int a, int e)
+  {
+    return graph.weight(e) + h[a] - h[graph.target(e)];
+  });
+}
+
+// Johnson's all pairs shortest paths for sparse graph which may have
+// negative weights, but no negative cycles. Potentials make weights
+// non-negative, then dijkstra() runs from every vertex on the pool, and
+// distance from s to t is d'(s, t) - h(s) + h(t), where d' is
+// distance in the reweighted graph. Matrix has to be made for size of
+// the graph, unreachable pairs get DistanceTraits<Weight>::infinity().
+// Distances which don't fit the distance type saturate as in
+// weights.h. Returns false if the graph has a negative cycle.
+// Complexity: O(VE + V(E + V)logV) time, O(V + E) memory per thread
+// besides the matrix.
+template <typename Vertex, typename Weight>
+inline bool johnson(
+  const BasicCsrGraph<Vertex, Weight>& graph,
+  ThreadPool& pool,
+  DistanceMatrix<typename DistanceTraits<Weight>::Distance>& matrix)
+{
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+  using Wide = Potential<Weight>;
+  std::vector<Wide> h;
+  if (!find_potentials(graph, h))
+  {
+    return false;
+  }
+  const auto reweighted = reweight(graph, h);
+
+  // Chunks of sources are rows of tiles, so every tile is written by
+  // one thread.
+  std::vector<std::vector<Wide>> distances(pool.size());
+  std::vector<std::vector<Distance>> rows(pool.size());
+  pool.for_each_indexed(graph.size(), DistanceMatrix<Distance>::tile,
+			[&](unsigned t, int s)
+  {
+    dijkstra(reweighted, s, distances[t]);
+    auto& row = rows[t];
+    row.assign(graph.size(), Traits::infinity());
+    for (int v = 0; v < graph.size(); ++v)
+    {
+      const Wide d = distances[t][v];
+      if (d == DistanceTraits<Wide>::infinity())
+      {
+	continue;
+      }
+      if constexpr (std::is_floating_point_v<Distance>)
+      {
+	row[v] = d + h[v] - h[s];
+      }
+      else
+      {
+	row[v] = std::clamp<Wide>(d + h[v] - h[s],
+				  std::numeric_limits<Distance>::lowest(),
+				  std::numeric_limits<Distance>::max());
+      }
+    }
+    matrix.set_row(s, row);
+  });
+  return true;
+}
+
+#endif  // _GRAPHS_JOHNSON_JOHNSON_H
@@ -0,0 +1,112 @@
+
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include "loader.h"
+#include "../dijkstra/dijkstra.h"
+
+void print_usage()
+{
+  std::cout << "usage: loader [options] file\n"
+	    << "-f fmt   format of file: dimacs, snap or csv "
+	    << "(default dimacs)\n"
+	    << "-c file  write graph to cache file\n"
+	    << "-o       file is a cache file\n"
+	    << "-s id    print distances from vertex id\n"
+	    << "-t num   amount of threads (default is all hardware threads)\n";
+}
+
+int main(int argc, char* argv[])
+{
+  Format format = Format::dimacs;
+  const char* cache = nullptr;
+  bool cached = false;
+  bool search = false;
+  int source = 0;
+  unsigned threads = 0;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:c:os:t:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'f':
+      if (strcmp(optarg, "dimacs") == 0)
+      {
+	format = Format::dimacs;
+      }
+      else if (strcmp(optarg, "snap") == 0)
+      {
+	format = Format::snap;
+      }
+      else if (strcmp(optarg, "csv") == 0)
+      {
+	format = Format::csv;
+      }
+      else
+      {
+	print_usage();
+	return 1;
+      }
+      break;
+    case 'c':
+      cache = optarg;
+      break;
+    case 'o':
+      cached = true;
+      break;
+    case 's':
+      search = true;
+      source = std::strtol(optarg, nullptr, 10);
+      break;
+    case 't':
+      threads = std::strtoul(optarg, nullptr, 10);
+      break;
+    default:
+      print_usage();
+      return 1;
+    }
+  }
+
+  if (optind + 1 != argc)
+  {
+    print_usage();
+    return 1;
+  }
+
+  ThreadPool pool(threads);
+  CsrGraph graph;
+  const bool loaded = cached
+    ? open_cache(argv[optind], graph)
+    : load_graph(argv[optind], format, pool, graph);
+  if (!loaded)
+  {
+    return 1;
+  }
+  std::cout << "vertices, edges: " << graph.size() << ", " << graph.edges()
+	    << "\n";
+
+  if (cache != nullptr && !write_cache(cache, graph))
+  {
+    return 1;
+  }
+
+  if (search)
+  {
+    const int v = graph.index(source);
+    if (v == -1)
+    {
+      std::cerr << "no vertex " << source << "\n";
+      return 1;
+    }
+    std::vector<int> distances;
+    dijkstra(graph, v, distances);
+    for (int u = 0; u < graph.size(); ++u)
+    {
+      std::cout << "v, d: " << graph.id(u) << ", " << distances[u] << "\n";
+    }
+  }
+  return 0;
+}
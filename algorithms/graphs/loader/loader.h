@@ -0,0 +1,433 @@
+#ifndef _GRAPHS_LOADER_LOADER_H
+#define _GRAPHS_LOADER_LOADER_H
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include "../common/graph.h"
+#include "../common/thread_pool.h"
+
+// Formats of edge list files.
+enum class Format
+{
+  // DIMACS shortest paths format: "c" comment lines, "p sp n m"
+  // problem line and "a u v w" arc lines.
+  dimacs,
+
+  // SNAP edge list: "#" comment lines and "u v" lines separated by
+  // whitespace, optional third column is weight.
+  snap,
+
+  // Comma separated "u,v" or "u,v,w" lines, header line is skipped.
+  csv
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+
+  // Map file fname. Mapping is empty if it fails.
+  explicit MappedFile(const char* fname);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile();
+
+  // Check whether file is mapped.
+  bool valid() const;
+
+  const char* data() const;
+  std::size_t size() const;
+
+private:
+
+  const char* data_;
+  std::size_t size_;
+  bool valid_;
+};
+
+inline MappedFile::MappedFile(const char* fname)
+  : data_(nullptr), size_(0), valid_(false)
+{
+  const int fd = open(fname, O_RDONLY);
+  if (fd == -1)
+  {
+    std::cerr << __func__ << ": can't open " << fname << ": "
+	      << strerror(errno) << "\n";
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1)
+  {
+    std::cerr << __func__ << ": fstat error: " << strerror(errno) << "\n";
+    close(fd);
+    return;
+  }
+
+  size_ = st.st_size;
+  if (size_ != 0)
+  {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      std::cerr << __func__ << ": mmap error: " << strerror(errno) << "\n";
+      close(fd);
+      return;
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(data);
+  }
+
+  close(fd);
+  valid_ = true;
+}
+
+inline MappedFile::~MappedFile()
+{
+  if (data_ != nullptr)
+  {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+inline bool MappedFile::valid() const
+{
+  return valid_;
+}
+
+inline const char* MappedFile::data() const
+{
+  return data_;
+}
+
+inline std::size_t MappedFile::size() const
+{
+  return size_;
+}
+
+// Outcome of parse_int.
+enum class Parsed
+{
+  // Integer is parsed.
+  ok,
+
+  // There is no integer before the end of line.
+  missing,
+
+  // Integer doesn't fit int.
+  overflow
+};
+
+// Parse integer at p, skipping spaces, tabs and commas in front of it.
+// It advances p past the integer. Value is set only if it fits int.
+inline Parsed parse_int(const char*& p, const char* end, int& value)
+{
+  while (p != end && (*p == ' ' || *p == '\t' || *p == ','))
+  {
+    ++p;
+  }
+
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    ++p;
+  }
+  if (p == end || *p < '0' || *p > '9')
+  {
+    return Parsed::missing;
+  }
+
+  // Digits past the range of int are consumed without accumulating,
+  // so x doesn't overflow on long runs.
+  const long long limit = static_cast<long long>(
+    std::numeric_limits<int>::max()) + 1;
+  long long x = 0;
+  while (p != end && *p >= '0' && *p <= '9')
+  {
+    if (x <= limit)
+    {
+      x = x * 10 + (*p - '0');
+    }
+    ++p;
+  }
+  if (x > limit || (x == limit && !negative))
+  {
+    return Parsed::overflow;
+  }
+  value = negative ? -x : x;
+  return Parsed::ok;
+}
+
+// Edges parsed from a part of file.
+struct ParsedEdges
+{
+  std::vector<Edge> edges;
+
+  // Amount of vertices n of DIMACS problem line "p sp n m", 0 if the
+  // part has no such line.
+  int vertices = 0;
+
+  // Amount of lines with ids or weights which don't fit int, they are
+  // not added to edges.
+  long long overflows = 0;
+};
+
+// Parse edges of lines which start in [begin, end). Lines which are
+// not edges (comments, headers) are skipped, missing weight is 1.
+inline void parse_edges(
+  const char* begin,
+  const char* end,
+  const char* limit,
+  Format format,
+  ParsedEdges& parsed)
+{
+  const char* p = begin;
+  while (p < end)
+  {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', limit - p));
+    if (eol == nullptr)
+    {
+      eol = limit;
+    }
+
+    while (p != eol && (*p == ' ' || *p == '\t'))
+    {
+      ++p;
+    }
+    if (format == Format::dimacs && p != eol && *p == 'p')
+    {
+      // Skip problem type and read amount of vertices.
+      ++p;
+      while (p != eol && (*p == ' ' || *p == '\t'))
+      {
+	++p;
+      }
+      while (p != eol && *p != ' ' && *p != '\t')
+      {
+	++p;
+      }
+      int n = 0;
+      const Parsed result = parse_int(p, eol, n);
+      if (result == Parsed::overflow || n < 0)
+      {
+	++parsed.overflows;
+      }
+      else if (result == Parsed::ok)
+      {
+	parsed.vertices = n;
+      }
+      p = eol + 1;
+      continue;
+    }
+    if (format == Format::dimacs)
+    {
+      p = p != eol && *p == 'a' ? p + 1 : eol;
+    }
+
+    Edge edge = {0, 0, 1};
+    const Parsed a = parse_int(p, eol, edge.a);
+    const Parsed b = a == Parsed::ok ? parse_int(p, eol, edge.b)
+      : Parsed::missing;
+    const Parsed w = b == Parsed::ok ? parse_int(p, eol, edge.w)
+      : Parsed::missing;
+    if (a == Parsed::overflow || b == Parsed::overflow
+	|| w == Parsed::overflow)
+    {
+      ++parsed.overflows;
+    }
+    else if (b == Parsed::ok)
+    {
+      parsed.edges.push_back(edge);
+    }
+    p = eol + 1;
+  }
+}
+
+// Load edges of edge list file. File is memory mapped and split into
+// chunks at line boundaries, chunks are parsed by threads of the pool
+// and their edges are concatenated in file order. Vertices is n of
+// DIMACS problem line, 0 if there is none. It returns false if file
+// can't be read or has values which don't fit int.
+inline bool load_edges(
+  const char* fname,
+  Format format,
+  ThreadPool& pool,
+  std::vector<Edge>& edges,
+  int& vertices)
+{
+  edges.clear();
+  vertices = 0;
+  MappedFile file(fname);
+  if (!file.valid())
+  {
+    return false;
+  }
+
+  const char* data = file.data();
+  const char* limit = data + file.size();
+  const std::size_t chunks = 4 * pool.size();
+  std::vector<ParsedEdges> parts(chunks);
+
+  // Chunk owns lines which start in it, so its boundaries are moved
+  // to the beginning of the next line.
+  auto boundary = [&](std::size_t i)
+  {
+    if (i == chunks)
+    {
+      return limit;
+    }
+    const char* p = data + file.size() * i / chunks;
+    while (p != data && p != limit && p[-1] != '\n')
+    {
+      ++p;
+    }
+    return p;
+  };
+
+  pool.for_each(chunks, 1, [&](int i)
+  {
+    parse_edges(boundary(i), boundary(i + 1), limit, format, parts[i]);
+  });
+
+  std::size_t total = 0;
+  long long overflows = 0;
+  for (const auto& part: parts)
+  {
+    total += part.edges.size();
+    overflows += part.overflows;
+    vertices = std::max(vertices, part.vertices);
+  }
+  if (overflows != 0)
+  {
+    std::cerr << __func__ << ": " << fname << " has " << overflows
+	      << " lines with values out of int range\n";
+    return false;
+  }
+
+  edges.reserve(total);
+  for (auto& part: parts)
+  {
+    edges.insert(edges.end(), part.edges.cbegin(), part.edges.cend());
+    std::vector<Edge>().swap(part.edges);
+  }
+  return true;
+}
+
+// Load graph from edge list file. Vertices of DIMACS file are ids
+// 1..n of its problem line, also the ones without arcs.
+inline bool load_graph(
+  const char* fname,
+  Format format,
+  ThreadPool& pool,
+  CsrGraph& graph)
+{
+  std::vector<Edge> edges;
+  int vertices = 0;
+  if (!load_edges(fname, format, pool, edges, vertices))
+  {
+    return false;
+  }
+  if (vertices != 0)
+  {
+    for (const auto& edge: edges)
+    {
+      if (edge.a < 1 || edge.a > vertices || edge.b < 1
+	  || edge.b > vertices)
+      {
+	std::cerr << __func__ << ": " << fname << " has arc " << edge.a
+		  << " " << edge.b << " out of vertices 1.." << vertices
+		  << "\n";
+	return false;
+      }
+    }
+  }
+  graph = CsrGraph::build(edges, 1, vertices);
+  return true;
+}
+
+// Header of graph cache file. It's followed by the block of CsrGraph
+// arrays, so the file can be mapped and used as is.
+struct CacheHeader
+{
+  char magic[8];
+  std::int64_t vertices;
+  std::int64_t edges;
+};
+
+constexpr char cache_magic[8] = {'C', 'S', 'R', 'G', 'R', 'P', 'H', '1'};
+
+// Write graph to cache file.
+inline bool write_cache(const char* fname, const CsrGraph& graph)
+{
+  FILE* out = fopen(fname, "wb");
+  if (out == nullptr)
+  {
+    std::cerr << __func__ << ": can't open " << fname << ": "
+	      << strerror(errno) << "\n";
+    return false;
+  }
+
+  CacheHeader header;
+  memcpy(header.magic, cache_magic, sizeof(header.magic));
+  header.vertices = graph.size();
+  header.edges = graph.edges();
+
+  const std::size_t size = CsrGraph::block_size(graph.size(), graph.edges());
+  const bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+    && fwrite(graph.block(), 1, size, out) == size;
+  if (fclose(out) != 0 || !ok)
+  {
+    std::cerr << __func__ << ": write error: " << strerror(errno) << "\n";
+    return false;
+  }
+  return true;
+}
+
+// Open graph cache file. Graph works directly on the memory mapping
+// of the file, which is released with the last copy of the graph.
+inline bool open_cache(const char* fname, CsrGraph& graph)
+{
+  auto file = std::make_shared<MappedFile>(fname);
+  if (!file->valid())
+  {
+    return false;
+  }
+
+  CacheHeader header;
+  if (file->size() < sizeof(header))
+  {
+    std::cerr << __func__ << ": " << fname << " is truncated\n";
+    return false;
+  }
+  memcpy(&header, file->data(), sizeof(header));
+
+  const std::size_t size =
+    CsrGraph::block_size(header.vertices, header.edges);
+  if (memcmp(header.magic, cache_magic, sizeof(header.magic)) != 0
+      || file->size() != sizeof(header) + size)
+  {
+    std::cerr << __func__ << ": " << fname << " is not a graph cache\n";
+    return false;
+  }
+
+  const char* block = file->data() + sizeof(header);
+  graph = CsrGraph(std::shared_ptr<const char>(file, block),
+		   header.vertices, header.edges);
+  return true;
+}
+
+#endif  // _GRAPHS_LOADER_LOADER_H
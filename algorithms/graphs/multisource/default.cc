@@ -0,0 +1,36 @@
+
+#include <vector>
+#include <iostream>
+#include "multi_source.h"
+
+int main()
+{
+
+  // 0----(4)---->1----(3)---->3
+  // |            ^
+  // |            |
+  // |           (2)
+  // |            |
+  // +----(1)---->2
+  Graph graph;
+  graph.add_edge(0, 1, 4);
+  graph.add_edge(0, 2, 1);
+  graph.add_edge(2, 1, 2);
+  graph.add_edge(1, 3, 3);
+  const CsrGraph csr = graph.freeze();
+  ThreadPool pool;
+  MultiSource engine(csr, pool);
+
+  const std::vector<int> sources = {csr.index(0), csr.index(2)};
+  std::vector<int> distances(sources.size() * csr.size());
+  engine.run(sources, distances.data());
+  for (std::size_t i = 0; i < sources.size(); ++i)
+  {
+    for (int v = 0; v < csr.size(); ++v)
+    {
+      std::cout << "s, v, d: " << csr.id(sources[i]) << ", " << csr.id(v)
+                << ", " << distances[i * csr.size() + v] << "\n";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,212 @@
+#ifndef _GRAPHS_MULTISOURCE_MULTI_SOURCE_H
+#define _GRAPHS_MULTISOURCE_MULTI_SOURCE_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include "../common/graph.h"
+#include "../common/weights.h"
+#include "../common/stats.h"
+#include "../common/thread_pool.h"
+
+// Reusable state of Dijkstra search over a graph of fixed size. Every
+// vertex has a generation stamp and its distance is valid only if the
+// stamp equals the current generation, so starting a new search is an
+// increment of the generation instead of O(V) initialization. Only
+// when generation counter wraps around stamps are cleared.
+template <typename Vertex, typename Weight>
+class SearchScratch
+{
+public:
+
+  using Traits = DistanceTraits<Weight>;
+  using Distance = typename Traits::Distance;
+
+  // Make scratch for graph of n vertices.
+  explicit SearchScratch(int n);
+
+  // Search shortest paths from dense vertex s.
+  void search(const BasicCsrGraph<Vertex, Weight>& graph, int s);
+
+  // Get distance of v found by the last search, Traits::infinity() if
+  // v isn't reachable.
+  Distance distance(int v) const;
+
+  // Get vertices reached by the last search in order of increasing
+  // distance.
+  const std::vector<int>& settled() const;
+
+private:
+
+  // Invalidate distances of the previous search.
+  void reset();
+
+  // Tentative distances, valid if stamp is current.
+  std::vector<Distance> distances_;
+
+  // Generation in which distance of vertex was set.
+  std::vector<unsigned> labeled_;
+
+  // Generation in which vertex was settled.
+  std::vector<unsigned> visited_;
+
+  // Current generation.
+  unsigned generation_;
+
+  // Queue of (distance, vertex) pairs.
+  std::vector<std::pair<Distance, int>> heap_;
+
+  // Settled vertices.
+  std::vector<int> settled_;
+};
+
+template <typename Vertex, typename Weight>
+inline SearchScratch<Vertex, Weight>::SearchScratch(int n)
+  : distances_(n), labeled_(n, 0), visited_(n, 0), generation_(0)
+{
+}
+
+template <typename Vertex, typename Weight>
+inline void SearchScratch<Vertex, Weight>::reset()
+{
+  if (++generation_ == 0)
+  {
+    std::fill(labeled_.begin(), labeled_.end(), 0);
+    std::fill(visited_.begin(), visited_.end(), 0);
+    generation_ = 1;
+  }
+  heap_.clear();
+  settled_.clear();
+}
+
+template <typename Vertex, typename Weight>
+inline typename SearchScratch<Vertex, Weight>::Distance
+SearchScratch<Vertex, Weight>::distance(int v) const
+{
+  if (labeled_[v] != generation_)
+  {
+    return Traits::infinity();
+  }
+  return distances_[v];
+}
+
+template <typename Vertex, typename Weight>
+inline const std::vector<int>& SearchScratch<Vertex, Weight>::settled() const
+{
+  return settled_;
+}
+
+template <typename Vertex, typename Weight>
+inline void SearchScratch<Vertex, Weight>::search(
+  const BasicCsrGraph<Vertex, Weight>& graph, int s)
+{
+  using Entry = std::pair<Distance, int>;
+  reset();
+  distances_[s] = 0;
+  labeled_[s] = generation_;
+  heap_.emplace_back(0, s);
+  GRAPHS_COUNT(pushes);
+
+  while (!heap_.empty())
+  {
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    const auto [du, u] = heap_.back();
+    heap_.pop_back();
+    GRAPHS_COUNT(pops);
+    if (visited_[u] == generation_)
+    {
+      continue;
+    }
+    visited_[u] = generation_;
+    settled_.push_back(u);
+
+    for (int e = graph.begin(u); e < graph.end(u); ++e)
+    {
+      GRAPHS_COUNT(relaxations);
+      const int b = graph.target(e);
+      const Distance d = Traits::add(du, graph.weight(e));
+      if (labeled_[b] != generation_ || distances_[b] > d)
+      {
+	distances_[b] = d;
+	labeled_[b] = generation_;
+	heap_.emplace_back(d, b);
+	GRAPHS_COUNT(pushes);
+	std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+      }
+    }
+  }
+}
+
+// Engine which answers batches of single source queries on threads of
+// the pool. Every thread owns a SearchScratch, so memory is allocated
+// once per engine and queries don't pay for initialization.
+template <typename Vertex, typename Weight>
+class MultiSource
+{
+public:
+
+  using Scratch = SearchScratch<Vertex, Weight>;
+  using Distance = typename Scratch::Distance;
+
+  // Make engine for the graph which runs on threads of the pool.
+  MultiSource(const BasicCsrGraph<Vertex, Weight>& graph, ThreadPool& pool);
+
+  // Search from every source and stream results: f(t, i, scratch) is
+  // called on thread t right after search from sources[i], scratch is
+  // valid only during the call.
+  template <typename F>
+  void run(const std::vector<int>& sources, F f);
+
+  // Search from every source and write distances from sources[i] to
+  // row distances[i * V, (i + 1) * V) of the caller's array.
+  void run(const std::vector<int>& sources, Distance* distances);
+
+private:
+
+  const BasicCsrGraph<Vertex, Weight>& graph_;
+
+  ThreadPool& pool_;
+
+  // Scratch of every thread of the pool.
+  std::vector<Scratch> scratch_;
+};
+
+template <typename Vertex, typename Weight>
+inline MultiSource<Vertex, Weight>::MultiSource(
+  const BasicCsrGraph<Vertex, Weight>& graph, ThreadPool& pool)
+  : graph_(graph),
+    pool_(pool),
+    scratch_(pool.size(), Scratch(graph.size()))
+{
+}
+
+template <typename Vertex, typename Weight>
+template <typename F>
+void MultiSource<Vertex, Weight>::run(const std::vector<int>& sources, F f)
+{
+  pool_.for_each_indexed(sources.size(), 1, [&](unsigned t, int i)
+  {
+    scratch_[t].search(graph_, sources[i]);
+    f(t, i, static_cast<const Scratch&>(scratch_[t]));
+  });
+}
+
+template <typename Vertex, typename Weight>
+inline void MultiSource<Vertex, Weight>::run(
+  const std::vector<int>& sources, Distance* distances)
+{
+  const std::size_t n = graph_.size();
+  run(sources, [&](unsigned, int i, const Scratch& scratch)
+  {
+    Distance* row = distances + i * n;
+    std::fill(row, row + n, Scratch::Traits::infinity());
+    for (const int v: scratch.settled())
+    {
+      row[v] = scratch.distance(v);
+    }
+  });
+}
+
+#endif  // _GRAPHS_MULTISOURCE_MULTI_SOURCE_H
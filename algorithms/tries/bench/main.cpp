@@ -0,0 +1,476 @@
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../r-way/trie.h"
+#include "../r-way/radix_trie.h"
+#include "../r-way/concurrent_trie.h"
+#include "../tst/tst.h"
+#include "../tst/radix_tst.h"
+
+/* Amount of heap bytes currently allocated by operator new. Size of
+ * every allocation is stored in a header in front of it, so the
+ * counter is exact and doesn't depend on the allocator. Counter is
+ * atomic since bulk_load allocates nodes from several threads.
+ */
+static std::atomic<std::size_t> g_live(0);
+static const std::size_t g_header = 16;
+
+void *operator new(std::size_t size) {
+    char *ptr = (char *)malloc(size + g_header);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+
+    *(std::size_t *)ptr = size;
+    g_live.fetch_add(size, std::memory_order_relaxed);
+    return ptr + g_header;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr == NULL)
+        return;
+
+    char *base = (char *)ptr - g_header;
+    g_live.fetch_sub(*(std::size_t *)base, std::memory_order_relaxed);
+    free(base);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+typedef std::chrono::steady_clock bench_clock;
+
+/* Seconds elapsed since start */
+static double elapsed(bench_clock::time_point start) {
+    std::chrono::duration<double> d = bench_clock::now() - start;
+    return d.count();
+}
+
+/* Uniform access to the dictionaries. Tries share the same
+ * interface, standard containers get overloads.
+ */
+template <typename Dict>
+static void put(Dict &dict, const std::string &key, int value) {
+    dict.insert(key, value);
+}
+
+template <typename Dict>
+static bool find(const Dict &dict, const std::string &key) {
+    return dict.contains(key);
+}
+
+template <typename Dict>
+static void drop(Dict &dict, const std::string &key) {
+    dict.erase(key);
+}
+
+typedef std::map<std::string, int> ordered_map;
+typedef std::unordered_map<std::string, int> hash_map;
+
+static void put(ordered_map &dict, const std::string &key, int value) {
+    dict[key] = value;
+}
+
+static bool find(const ordered_map &dict, const std::string &key) {
+    return dict.find(key) != dict.end();
+}
+
+static void drop(ordered_map &dict, const std::string &key) {
+    dict.erase(key);
+}
+
+static void put(hash_map &dict, const std::string &key, int value) {
+    dict[key] = value;
+}
+
+static bool find(const hash_map &dict, const std::string &key) {
+    return dict.find(key) != dict.end();
+}
+
+static void drop(hash_map &dict, const std::string &key) {
+    dict.erase(key);
+}
+
+/* Measure one dictionary on one dataset and print a row of results.
+ * Keys are inserted in shuffled order, looked up in another shuffled
+ * order (every lookup is a hit), and then erased. Latency is measured
+ * for every lookup separately, in a pass which is not used for
+ * throughput, so clock overhead doesn't affect ops/sec.
+ *
+ * make - function which allocates empty dictionary
+ */
+template <typename Dict, typename Make>
+static void run(const char *name, Make make,
+        const std::vector<std::string> &keys,
+        const std::vector<std::string> &queries) {
+
+    std::size_t before = g_live.load();
+    bench_clock::time_point start = bench_clock::now();
+
+    Dict *dict = make();
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        put(*dict, keys[i], (int)i + 1);
+
+    double insert_time = elapsed(start);
+    double bytes = (double)(g_live.load() - before) / keys.size();
+
+    std::size_t found = 0;
+    start = bench_clock::now();
+    for (const std::string &key: queries)
+        found += find(*dict, key);
+    double lookup_time = elapsed(start);
+
+    std::vector<double> latency;
+    latency.reserve(queries.size());
+    for (const std::string &key: queries) {
+        bench_clock::time_point t = bench_clock::now();
+        found += find(*dict, key);
+        latency.push_back(elapsed(t) * 1e9);
+    }
+
+    std::sort(latency.begin(), latency.end());
+    double p50 = latency[latency.size() / 2];
+    double p99 = latency[latency.size() * 99 / 100];
+
+    start = bench_clock::now();
+    for (const std::string &key: queries)
+        drop(*dict, key);
+    double erase_time = elapsed(start);
+
+    delete dict;
+
+    if (found != 2 * queries.size())
+        fprintf(stderr, "%s: lookup missed %zu keys\n", name,
+                2 * queries.size() - found);
+
+    printf("  %-12s %10.3f %10.3f %10.3f %8.0f %8.0f %10.1f\n", name,
+            keys.size() / insert_time / 1e6,
+            queries.size() / lookup_time / 1e6,
+            queries.size() / erase_time / 1e6,
+            p50, p99, bytes);
+}
+
+/* Lookup counters of one reader. Every reader has its own cache line,
+ * so counting doesn't make readers share lines.
+ */
+struct alignas(64) ReaderCount {
+    long lookups;
+    long found;
+};
+
+/* Measure how lookups of concurrent trie scale with amount of readers.
+ * Readers look up keys in a loop while one writer replaces values of
+ * the keys and inserts and erases keys which are not looked up. Keys
+ * are capped, since every node of the trie holds 256 links.
+ */
+static void run_readers(const std::vector<std::string> &keys) {
+    static const int s_max_readers = 8;
+    static const double s_duration = 0.2;
+    std::vector<std::string> shared_keys(keys.begin(),
+            keys.begin() + std::min<std::size_t>(keys.size(), 1024));
+
+    ConcurrentTrie<int> trie;
+    for (std::size_t i = 0; i < shared_keys.size(); ++i)
+        trie.insert(shared_keys[i], (int)i + 1);
+
+    printf("  %-12s %10s %10s %10s\n", "readers", "get Mop/s",
+            "per reader", "put Mop/s");
+    for (int readers = 1; readers <= s_max_readers; readers *= 2) {
+        ReaderCount counts[s_max_readers];
+        std::atomic<bool> done(false);
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            counts[r].lookups = 0;
+            counts[r].found = 0;
+            threads.emplace_back([&, r]() {
+                std::size_t i = r * shared_keys.size() / readers;
+                while (!done.load(std::memory_order_relaxed)) {
+                    counts[r].found += trie.contains(shared_keys[i]);
+                    ++counts[r].lookups;
+                    if (++i == shared_keys.size())
+                        i = 0;
+                }
+            });
+        }
+
+        long updates = 0;
+        std::thread writer([&]() {
+            std::size_t i = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                trie.insert(shared_keys[i], (int)updates);
+                trie.insert(shared_keys[i] + "~", (int)updates);
+                trie.erase(shared_keys[i] + "~");
+                updates += 3;
+                if (++i == shared_keys.size())
+                    i = 0;
+            }
+        });
+
+        std::this_thread::sleep_for(
+                std::chrono::duration<double>(s_duration));
+        done.store(true);
+        for (std::thread &thread: threads)
+            thread.join();
+        writer.join();
+
+        long lookups = 0;
+        long found = 0;
+        for (int r = 0; r < readers; ++r) {
+            lookups += counts[r].lookups;
+            found += counts[r].found;
+        }
+        if (found != lookups)
+            fprintf(stderr, "%s: lookup missed %ld keys\n", __func__,
+                    lookups - found);
+
+        char name[32];
+        snprintf(name, sizeof(name), "readers-%d", readers);
+        printf("  %-12s %10.3f %10.3f %10.3f\n", name,
+                lookups / s_duration / 1e6,
+                lookups / s_duration / 1e6 / readers,
+                updates / s_duration / 1e6);
+    }
+}
+
+/* Generators of datasets. All of them return n distinct keys. */
+
+/* Words made of random syllables, the shape of english words */
+static std::vector<std::string> make_words(std::size_t n,
+        std::mt19937 &rng) {
+    static const char *const onsets[] = {
+        "", "b", "c", "d", "f", "g", "h", "l", "m", "n", "p", "r", "s",
+        "t", "v", "w", "br", "ch", "cr", "pl", "sh", "st", "th", "tr"
+    };
+    static const char *const vowels[] = {
+        "a", "e", "i", "o", "u", "ai", "ea", "ee", "ou", "oo"
+    };
+    static const char *const codas[] = {
+        "", "", "", "n", "r", "s", "t", "ng", "ck", "st"
+    };
+    static const char *const suffixes[] = {
+        "", "", "", "", "s", "ed", "ing", "er", "ly", "ness", "tion"
+    };
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> keys;
+    while (keys.size() < n) {
+        std::string word;
+        int syllables = 1 + rng() % 3 + rng() % 2;
+        for (int i = 0; i < syllables; ++i) {
+            word += onsets[rng() % (sizeof(onsets) / sizeof(*onsets))];
+            word += vowels[rng() % (sizeof(vowels) / sizeof(*vowels))];
+            word += codas[rng() % (sizeof(codas) / sizeof(*codas))];
+        }
+        word += suffixes[rng() % (sizeof(suffixes) / sizeof(*suffixes))];
+
+        if (seen.insert(word).second)
+            keys.push_back(word);
+    }
+
+    return keys;
+}
+
+/* URLs: few hosts, paths of words, numeric ids */
+static std::vector<std::string> make_urls(std::size_t n,
+        std::mt19937 &rng) {
+    std::vector<std::string> words = make_words(1000, rng);
+    std::vector<std::string> hosts;
+    for (int i = 0; i < 50; ++i)
+        hosts.push_back("https://www." + words[i] + ".com/");
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> keys;
+    while (keys.size() < n) {
+        std::string url = hosts[rng() % hosts.size()];
+        int depth = 1 + rng() % 4;
+        for (int i = 0; i < depth; ++i)
+            url += words[rng() % words.size()] + "/";
+        if (rng() % 2)
+            url += "item?id=" + std::to_string(rng() % 1000000);
+
+        if (seen.insert(url).second)
+            keys.push_back(url);
+    }
+
+    return keys;
+}
+
+/* Random binary keys of length 8..16 */
+static std::vector<std::string> make_binary(std::size_t n,
+        std::mt19937 &rng) {
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> keys;
+    while (keys.size() < n) {
+        std::string key(8 + rng() % 9, '\0');
+        for (char &c: key)
+            c = (char)(rng() % 256);
+
+        if (seen.insert(key).second)
+            keys.push_back(key);
+    }
+
+    return keys;
+}
+
+/* Keys with long common prefix and short distinct tails, such as
+ * generated file names.
+ */
+static std::vector<std::string> make_prefixed(std::size_t n,
+        std::mt19937 &rng) {
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < n; ++i) {
+        keys.push_back("/var/lib/service/storage/shard-" +
+                std::to_string(i % 16) + "/segment-" +
+                std::to_string(i) + ".dat");
+    }
+
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+/* Read words from file, one per line, at most n distinct words */
+static std::vector<std::string> load_words(const char *fname,
+        std::size_t n) {
+    std::ifstream in(fname);
+    if (!in)
+        fprintf(stderr, "%s: can't open %s\n", __func__, fname);
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> keys;
+    std::string line;
+    while (keys.size() < n && std::getline(in, line)) {
+        if (!line.empty() && seen.insert(line).second)
+            keys.push_back(line);
+    }
+
+    return keys;
+}
+
+/* Run all dictionaries on the dataset */
+static void run_all(const char *dataset, std::vector<std::string> keys,
+        std::mt19937 &rng) {
+
+    if (keys.empty())
+        return;
+
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<std::string> queries(keys);
+    std::shuffle(queries.begin(), queries.end(), rng);
+
+    printf("%s (%zu keys)\n", dataset, keys.size());
+    printf("  %-12s %10s %10s %10s %8s %8s %10s\n", "structure",
+            "ins Mop/s", "get Mop/s", "del Mop/s", "p50 ns", "p99 ns",
+            "bytes/key");
+
+    run<Trie<int>>("trie", []() { return new Trie<int>(); },
+            keys, queries);
+    run<RadixTrie<int>>("radix-trie", []() { return new RadixTrie<int>(); },
+            keys, queries);
+    run<Tst>("tst", []() { return new Tst(); }, keys, queries);
+    run<Tst>("tst-r2", []() { return new Tst(true); }, keys, queries);
+    run<RadixTst>("radix-tst", []() { return new RadixTst(); },
+            keys, queries);
+    run<ordered_map>("std::map", []() { return new ordered_map(); },
+            keys, queries);
+    run<hash_map>("unordered", []() { return new hash_map(); },
+            keys, queries);
+
+    /* Cold start build of the r-way trie from sorted input */
+    std::vector<std::pair<std::string, int>> sorted;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        sorted.push_back(std::make_pair(keys[i], (int)i + 1));
+    std::sort(sorted.begin(), sorted.end());
+
+    bench_clock::time_point start = bench_clock::now();
+    Trie<int> *trie = new Trie<int>();
+    trie->bulk_load(sorted.begin(), sorted.end());
+    double load_time = elapsed(start);
+
+    printf("  %-12s %10.3f\n", "trie-bulk", keys.size() / load_time / 1e6);
+
+    /* Full ordered scans with cursors */
+    std::size_t scanned = 0;
+    start = bench_clock::now();
+    TrieCursor<int> trie_cursor(*trie);
+    for (trie_cursor.first(); trie_cursor.valid(); trie_cursor.next())
+        scanned += trie_cursor.key().size();
+    double trie_scan = elapsed(start);
+    delete trie;
+
+    Tst tst;
+    tst.build(sorted);
+    start = bench_clock::now();
+    TstCursor tst_cursor(tst);
+    for (tst_cursor.first(); tst_cursor.valid(); tst_cursor.next())
+        scanned += tst_cursor.key().size();
+    double tst_scan = elapsed(start);
+
+    printf("  %-12s %10.3f\n", "trie-scan", keys.size() / trie_scan / 1e6);
+    printf("  %-12s %10.3f\n", "tst-scan", keys.size() / tst_scan / 1e6);
+    if (scanned == 0)
+        fprintf(stderr, "%s: nothing scanned\n", dataset);
+
+    run_readers(keys);
+}
+
+void print_usage(void) {
+    const char *const usage = \
+        "usage: bench [options]\n" \
+        "-n num   amount of keys in every dataset (default 20000)\n" \
+        "-f file  use words from file (one per line) as english words\n" \
+        "-s seed  seed of random generator\n";
+
+    printf("%s", usage);
+}
+
+int main(int argc, char *argv[]) {
+    std::size_t n = 20000;
+    const char *words = NULL;
+    unsigned seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:f:s:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            words = optarg;
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (n == 0) {
+        print_usage();
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    run_all("words", words != NULL ?
+            load_words(words, n) : make_words(n, rng), rng);
+    run_all("urls", make_urls(n, rng), rng);
+    run_all("binary", make_binary(n, rng), rng);
+    run_all("prefixed", make_prefixed(n, rng), rng);
+    return 0;
+}
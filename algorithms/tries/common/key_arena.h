@@ -0,0 +1,82 @@
+#ifndef _TRIES_COMMON_KEY_ARENA_H
+#define _TRIES_COMMON_KEY_ARENA_H
+
+#include <string.h>
+#include <cstddef>
+#include <vector>
+
+/* Reference to the bytes of edge label stored in the key arena */
+struct Label {
+    std::size_t offset;
+    std::size_t length;
+};
+
+/* Append only storage of key bytes. Radix tries keep edge labels as
+ * (offset, length) references into the arena instead of separate
+ * strings. Key suffix is appended once when it's inserted, edge
+ * split produces two references into the same bytes. References are
+ * offsets, so they stay valid when the arena grows. Bytes of erased
+ * keys are not reclaimed.
+ */
+class KeyArena {
+    public:
+
+        KeyArena();
+        KeyArena(const KeyArena &) = delete;
+        KeyArena &operator= (const KeyArena &) = delete;
+
+        /* Append bytes to the arena and return label referring to
+         * them.
+         */
+        Label append(const char *data, std::size_t length);
+
+        /* Append concatenation of two labels to the arena and return
+         * label referring to it. If labels are adjacent in the arena
+         * then no bytes are appended.
+         */
+        Label join(const Label &head, const Label &tail);
+
+        /* Get pointer to the first byte of label */
+        const char *data(const Label &label) const;
+
+        /* Amount of bytes in the arena */
+        std::size_t size() const;
+
+    private:
+
+        std::vector<char> m_bytes;
+};
+
+inline KeyArena::KeyArena()
+{}
+
+inline Label KeyArena::append(const char *data, std::size_t length) {
+    Label label = {m_bytes.size(), length};
+    m_bytes.insert(m_bytes.end(), data, data + length);
+    return label;
+}
+
+inline Label KeyArena::join(const Label &head, const Label &tail) {
+    if (head.offset + head.length == tail.offset) {
+        Label label = {head.offset, head.length + tail.length};
+        return label;
+    }
+
+    Label label = {m_bytes.size(), head.length + tail.length};
+    m_bytes.resize(m_bytes.size() + label.length);
+    char *bytes = m_bytes.data();
+    memmove(bytes + label.offset, bytes + head.offset, head.length);
+    memmove(bytes + label.offset + head.length, bytes + tail.offset,
+            tail.length);
+    return label;
+}
+
+inline const char *KeyArena::data(const Label &label) const {
+    return m_bytes.data() + label.offset;
+}
+
+inline std::size_t KeyArena::size() const {
+    return m_bytes.size();
+}
+
+#endif  /* _TRIES_COMMON_KEY_ARENA_H */
@@ -0,0 +1,32 @@
+#ifndef _TRIES_COMMON_LEVENSHTEIN_H
+#define _TRIES_COMMON_LEVENSHTEIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+/* Row of Levenshtein DP table for the query and key prefix is
+ * prev, compute row for the key prefix extended by character c.
+ * Rows have query.size() + 1 elements, element j is the edit
+ * distance between the key prefix and the first j characters of
+ * the query. It returns minimum of the new row, which is a lower
+ * bound of distance for every key with this prefix, so sub-trie can
+ * be skipped when it exceeds the limit.
+ */
+inline int levenshtein_row(const std::string &query, const int *prev,
+        int *next, unsigned char c) {
+
+    next[0] = prev[0] + 1;
+    int min = next[0];
+
+    for (std::size_t j = 1; j <= query.size(); ++j) {
+        int cost = (unsigned char)query[j - 1] == c ? 0 : 1;
+        next[j] = std::min(std::min(prev[j], next[j - 1]) + 1,
+                prev[j - 1] + cost);
+        min = std::min(min, next[j]);
+    }
+
+    return min;
+}
+
+#endif  /* _TRIES_COMMON_LEVENSHTEIN_H */
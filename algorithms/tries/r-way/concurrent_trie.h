@@ -0,0 +1,454 @@
+#ifndef _TRIES_R_WAY_CONCURRENT_TRIE_H
+#define _TRIES_R_WAY_CONCURRENT_TRIE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Process wide numbering of threads. Every thread which uses
+ * concurrent trie gets a small number which is used as index of its
+ * slot in the epoch tables. Number is returned to the pool when the
+ * thread exits.
+ */
+class ThreadSlot {
+    public:
+
+        ThreadSlot(const ThreadSlot &) = delete;
+        ThreadSlot &operator= (const ThreadSlot &) = delete;
+
+        /* Get number of the calling thread */
+        static int get();
+
+        /* Maximum amount of threads alive at the same time */
+        static const int s_max = 128;
+
+    private:
+
+        ThreadSlot();
+       ~ThreadSlot();
+
+        /* Table of used numbers */
+        static std::atomic<bool> *used();
+
+        int m_slot;
+};
+
+inline ThreadSlot::ThreadSlot()
+    :m_slot(-1)
+{
+    std::atomic<bool> *table = used();
+    for (int i = 0; i < s_max; ++i) {
+        bool expected = false;
+        if (table[i].compare_exchange_strong(expected, true)) {
+            m_slot = i;
+            return;
+        }
+    }
+
+    fprintf(stderr, "%s: too many threads\n", __func__);
+    fprintf(stderr, "%s: expected at most %d\n", __func__, s_max);
+    abort();
+}
+
+inline ThreadSlot::~ThreadSlot() {
+    used()[m_slot].store(false);
+}
+
+inline std::atomic<bool> *ThreadSlot::used() {
+    static std::atomic<bool> table[s_max] = {};
+    return table;
+}
+
+inline int ThreadSlot::get() {
+    static thread_local ThreadSlot slot;
+    return slot.m_slot;
+}
+
+/* Epoch based reclamation of memory shared between lock free readers
+ * and a single writer.
+ *
+ * Reader announces the global epoch it has observed in its slot
+ * before touching shared memory (pin) and clears the slot afterwards
+ * (unpin). Writer doesn't free unlinked memory immediately. It puts
+ * it to the limbo list of the current epoch (retire). Global epoch is
+ * advanced only when all pinned readers have observed it. After two
+ * advances no reader can hold pointer to memory retired in the old
+ * epoch, so it's freed. Readers never wait for the writer and for
+ * each other, both pin and unpin are a couple of stores.
+ *
+ * Pins are not reentrant: thread has to unpin before it pins the
+ * same epoch again.
+ */
+class Epoch {
+    public:
+
+        Epoch();
+        Epoch(const Epoch &) = delete;
+        Epoch &operator= (const Epoch &) = delete;
+       ~Epoch();
+
+        /* Enter read side critical section */
+        void pin();
+
+        /* Leave read side critical section */
+        void unpin();
+
+        /* Defer del(ptr) until no reader can access ptr. Must be
+         * called by the writer only.
+         */
+        void retire(void *ptr, void (*del)(void *));
+
+        /* Try to advance epoch and free memory which is not
+         * accessible by readers anymore. Must be called by the
+         * writer only. Returns false if some reader still runs in
+         * the previous epoch.
+         */
+        bool reclaim();
+
+    private:
+
+        /* Slot state is 0 for thread outside of critical section,
+         * otherwise it's observed epoch shifted left by one bit with
+         * the lowest bit set. Slot is padded to the size of cache
+         * line, so readers don't share lines.
+         */
+        struct Slot {
+            std::atomic<uint64_t> state;
+            char pad[64 - sizeof(std::atomic<uint64_t>)];
+        };
+
+        /* Memory waiting for reclamation */
+        struct Retired {
+            void *ptr;
+            void (*del)(void *);
+        };
+
+        /* Free all memory from the limbo list */
+        static void free_list(std::vector<Retired> &list);
+
+        Slot m_slots[ThreadSlot::s_max];
+        char m_pad[64];
+        std::atomic<uint64_t> m_epoch;
+        std::vector<Retired> m_limbo[3];
+};
+
+inline Epoch::Epoch() {
+    for (int i = 0; i < ThreadSlot::s_max; ++i)
+        m_slots[i].state.store(0, std::memory_order_relaxed);
+
+    m_epoch.store(0, std::memory_order_relaxed);
+}
+
+inline Epoch::~Epoch() {
+    for (int i = 0; i < 3; ++i)
+        free_list(m_limbo[i]);
+}
+
+inline void Epoch::pin() {
+    uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    Slot &slot = m_slots[ThreadSlot::get()];
+    slot.state.store((epoch << 1) | 1, std::memory_order_relaxed);
+
+    /* Pairs with the fence in reclaim. Either writer sees the slot,
+     * or reader sees all unlinks made before the epoch advance.
+     */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+inline void Epoch::unpin() {
+    Slot &slot = m_slots[ThreadSlot::get()];
+    slot.state.store(0, std::memory_order_release);
+}
+
+inline void Epoch::retire(void *ptr, void (*del)(void *)) {
+    uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    m_limbo[epoch % 3].push_back(Retired{ptr, del});
+}
+
+inline bool Epoch::reclaim() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    for (int i = 0; i < ThreadSlot::s_max; ++i) {
+        uint64_t state = m_slots[i].state.load(std::memory_order_acquire);
+        if ((state & 1) && (state >> 1) != epoch)
+            return false;
+    }
+
+    /* All pinned readers are in the current epoch, so nobody can
+     * access memory retired two epochs ago. Its limbo list is reused
+     * for the new epoch.
+     */
+    m_epoch.store(epoch + 1, std::memory_order_release);
+    free_list(m_limbo[(epoch + 1) % 3]);
+    return true;
+}
+
+inline void Epoch::free_list(std::vector<Retired> &list) {
+    for (const Retired &i: list)
+        i.del(i.ptr);
+
+    list.clear();
+}
+
+/* Node of the concurrent r-way trie. Links and value are atomic
+ * pointers, so readers always see either old or new fully built
+ * object. Value is stored in a separate heap object and it's never
+ * modified in place, writer replaces it.
+ */
+template <typename T>
+class ConcurrentNode {
+    public:
+
+        ConcurrentNode();
+        ConcurrentNode(const ConcurrentNode &) = delete;
+        ConcurrentNode &operator= (const ConcurrentNode &) = delete;
+       ~ConcurrentNode();
+
+        static const int s_base = 256;
+
+        /* Set of child nodes */
+        std::atomic<ConcurrentNode *> m_next[s_base];
+
+        /* Node's value, NULL if there is no key for this node */
+        std::atomic<T *> m_value;
+};
+
+template <typename T>
+ConcurrentNode<T>::ConcurrentNode() {
+    for (int c = 0; c < s_base; ++c)
+        m_next[c].store(NULL, std::memory_order_relaxed);
+
+    m_value.store(NULL, std::memory_order_relaxed);
+}
+
+/* Children are not deleted with the node. Only leaf nodes are
+ * retired, the whole trie is deleted by ConcurrentTrie<T>::delete_tree.
+ */
+template <typename T>
+ConcurrentNode<T>::~ConcurrentNode() {
+    delete m_value.load(std::memory_order_relaxed);
+}
+
+/* R-way trie which can be read by any number of threads while it's
+ * updated. Lookups take no locks and never wait: they pin the epoch,
+ * walk down acquiring links and unpin. Updates are serialized by a
+ * mutex. New nodes and values are fully built before they are
+ * published with a single atomic store, unlinked nodes and replaced
+ * values are retired to the epoch and freed when no reader can see
+ * them anymore.
+ */
+template <typename T>
+class ConcurrentTrie {
+    public:
+
+        ConcurrentTrie();
+        ConcurrentTrie(const ConcurrentTrie &) = delete;
+        ConcurrentTrie &operator= (const ConcurrentTrie &) = delete;
+       ~ConcurrentTrie();
+
+        /* Same as Trie<T>::insert. Safe to call concurrently with
+         * lookups and other updates.
+         */
+        void insert(const std::string &key, const T &value);
+
+        /* Same as Trie<T>::erase. Safe to call concurrently with
+         * lookups and other updates.
+         */
+        void erase(const std::string &key);
+
+        /* Same as Trie<T>::get. Wait free. */
+        std::pair<bool, T> get(const std::string &key) const;
+
+        /* Same as Trie<T>::contains. Wait free. */
+        bool contains(const std::string &key) const;
+
+        /* Free memory retired by previous updates if readers allow it.
+         * Updates do it themselves every s_batch retired objects.
+         */
+        void reclaim();
+
+    private:
+
+        typedef ConcurrentNode<T> Node;
+
+        /* Deleters used for retired objects */
+        static void delete_node(void *ptr);
+        static void delete_value(void *ptr);
+
+        /* Delete sub-trie rooted at node */
+        static void delete_tree(Node *node);
+
+        /* Is node from arguments leaf node? */
+        static bool leaf_node(const Node *node);
+
+        /* Retire object and reclaim memory if enough is retired */
+        void retire(void *ptr, void (*del)(void *));
+
+        /* Root node of trie, it's never erased */
+        Node *m_root;
+
+        /* Reclamation of memory which may be used by readers */
+        mutable Epoch m_epoch;
+
+        /* Updates are serialized */
+        std::mutex m_writer;
+
+        /* Amount of objects retired since last reclaim */
+        std::size_t m_retired;
+
+        static const std::size_t s_batch = 64;
+};
+
+template <typename T>
+ConcurrentTrie<T>::ConcurrentTrie()
+    :m_root(new Node())
+    ,m_retired(0)
+{}
+
+template <typename T>
+ConcurrentTrie<T>::~ConcurrentTrie() {
+    delete_tree(m_root);
+}
+
+template <typename T>
+void ConcurrentTrie<T>::delete_node(void *ptr) {
+    delete static_cast<Node *>(ptr);
+}
+
+template <typename T>
+void ConcurrentTrie<T>::delete_value(void *ptr) {
+    delete static_cast<T *>(ptr);
+}
+
+template <typename T>
+void ConcurrentTrie<T>::delete_tree(Node *node) {
+    if (node == NULL)
+        return;
+
+    for (int c = 0; c < Node::s_base; ++c)
+        delete_tree(node->m_next[c].load(std::memory_order_relaxed));
+
+    delete node;
+}
+
+template <typename T>
+bool ConcurrentTrie<T>::leaf_node(const Node *node) {
+    for (int c = 0; c < Node::s_base; ++c) {
+        if (node->m_next[c].load(std::memory_order_relaxed) != NULL)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+void ConcurrentTrie<T>::retire(void *ptr, void (*del)(void *)) {
+    m_epoch.retire(ptr, del);
+    if (++m_retired >= s_batch && m_epoch.reclaim())
+        m_retired = 0;
+}
+
+template <typename T>
+void ConcurrentTrie<T>::reclaim() {
+    std::lock_guard<std::mutex> lock(m_writer);
+    if (m_epoch.reclaim())
+        m_retired = 0;
+}
+
+template <typename T>
+void ConcurrentTrie<T>::insert(const std::string &key, const T &value) {
+    std::lock_guard<std::mutex> lock(m_writer);
+
+    /* Writer is the only thread which modifies links, so it reads
+     * them relaxed. Missing nodes are published with release store
+     * after construction.
+     */
+    Node *node = m_root;
+    for (std::size_t depth = 0; depth < key.size(); ++depth) {
+        unsigned char c = key[depth];
+        Node *next = node->m_next[c].load(std::memory_order_relaxed);
+        if (next == NULL) {
+            next = new Node();
+            node->m_next[c].store(next, std::memory_order_release);
+        }
+        node = next;
+    }
+
+    T *old = node->m_value.exchange(new T(value), std::memory_order_acq_rel);
+    if (old != NULL)
+        retire(old, delete_value);
+}
+
+template <typename T>
+void ConcurrentTrie<T>::erase(const std::string &key) {
+    std::lock_guard<std::mutex> lock(m_writer);
+
+    std::vector<Node *> path;
+    path.reserve(key.size() + 1);
+
+    Node *node = m_root;
+    path.push_back(node);
+    for (std::size_t depth = 0; depth < key.size(); ++depth) {
+        unsigned char c = key[depth];
+        node = node->m_next[c].load(std::memory_order_relaxed);
+        if (node == NULL)
+            return;
+        path.push_back(node);
+    }
+
+    T *old = node->m_value.exchange(NULL, std::memory_order_acq_rel);
+    if (old == NULL)
+        return;
+
+    retire(old, delete_value);
+
+    /* Unlink intermediate nodes which don't lead to any key anymore
+     * on the way back to the root. Readers which are already inside
+     * of unlinked sub-trie finish their walk on retired nodes.
+     */
+    for (std::size_t depth = key.size(); depth > 0; --depth) {
+        node = path[depth];
+        if (!leaf_node(node) ||
+            node->m_value.load(std::memory_order_relaxed) != NULL)
+            break;
+
+        unsigned char c = key[depth - 1];
+        path[depth - 1]->m_next[c].store(NULL, std::memory_order_release);
+        retire(node, delete_node);
+    }
+}
+
+template <typename T>
+std::pair<bool, T> ConcurrentTrie<T>::get(const std::string &key) const {
+    m_epoch.pin();
+
+    const Node *node = m_root;
+    for (std::size_t depth = 0; depth < key.size() && node != NULL; ++depth) {
+        unsigned char c = key[depth];
+        node = node->m_next[c].load(std::memory_order_acquire);
+    }
+
+    const T *value = NULL;
+    if (node != NULL)
+        value = node->m_value.load(std::memory_order_acquire);
+
+    std::pair<bool, T> result = value != NULL ?
+        std::make_pair(true, *value) : std::make_pair(false, T());
+
+    m_epoch.unpin();
+    return result;
+}
+
+template <typename T>
+bool ConcurrentTrie<T>::contains(const std::string &key) const {
+    return get(key).first;
+}
+
+#endif  /* _TRIES_R_WAY_CONCURRENT_TRIE_H */
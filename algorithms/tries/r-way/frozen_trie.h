@@ -0,0 +1,630 @@
+#ifndef _TRIES_R_WAY_FROZEN_TRIE_H
+#define _TRIES_R_WAY_FROZEN_TRIE_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "trie.h"
+
+/* Read only view of a bit vector with rank/select support. Bits are
+ * stored in 64-bit words, bit i is (words[i / 64] >> (i % 64)) & 1.
+ * Rank directory keeps amount of ones before every block of
+ * s_block words, so rank is one directory lookup plus at most
+ * s_block popcounts. Select is a binary search over the directory
+ * followed by a scan inside of the block. Neither bits nor directory
+ * are owned by the object, they usually point into mapped file.
+ */
+class BitRank {
+    public:
+
+        BitRank();
+
+        /* Attach view to bits and rank directory. Size is amount of
+         * bits in the vector.
+         */
+        void assign(const uint64_t *bits, const uint64_t *ranks,
+                uint64_t size);
+
+        /* Get value of bit i */
+        bool get(uint64_t i) const;
+
+        /* Amount of ones in range [0, i) */
+        uint64_t rank1(uint64_t i) const;
+
+        /* Position of k'th zero (counting from 0) */
+        uint64_t select0(uint64_t k) const;
+
+        /* Amount of 64-bit words needed for bit vector of size bits */
+        static uint64_t words(uint64_t size);
+
+        /* Amount of directory entries needed for bit vector of size
+         * bits. There is one extra entry at the end so the last block
+         * doesn't need special handling.
+         */
+        static uint64_t blocks(uint64_t size);
+
+        /* Compute rank directory for bit vector in arguments */
+        static void build_ranks(const std::vector<uint64_t> &bits,
+                uint64_t size, std::vector<uint64_t> &ranks);
+
+        /* Amount of words in one directory block */
+        static const uint64_t s_block = 8;
+
+    private:
+
+        const uint64_t *m_bits;
+        const uint64_t *m_ranks;
+        uint64_t        m_size;
+};
+
+inline BitRank::BitRank()
+    :m_bits(NULL)
+    ,m_ranks(NULL)
+    ,m_size(0)
+{}
+
+inline void BitRank::assign(const uint64_t *bits, const uint64_t *ranks,
+        uint64_t size) {
+    m_bits  = bits;
+    m_ranks = ranks;
+    m_size  = size;
+}
+
+inline bool BitRank::get(uint64_t i) const {
+    return (m_bits[i / 64] >> (i % 64)) & 1;
+}
+
+inline uint64_t BitRank::rank1(uint64_t i) const {
+    uint64_t word  = i / 64;
+    uint64_t block = word / s_block;
+    uint64_t rank  = m_ranks[block];
+
+    for (uint64_t w = block * s_block; w < word; ++w)
+        rank += __builtin_popcountll(m_bits[w]);
+
+    if (i % 64 != 0) {
+        uint64_t mask = (uint64_t(1) << (i % 64)) - 1;
+        rank += __builtin_popcountll(m_bits[word] & mask);
+    }
+
+    return rank;
+}
+
+inline uint64_t BitRank::select0(uint64_t k) const {
+
+    /* Find the last block which has no more than k zeros before it.
+     * Padding bits after the end of vector are zeros, but they are
+     * never reached because k'th zero exists inside of the vector.
+     */
+    uint64_t lo = 0;
+    uint64_t hi = blocks(m_size) - 1;
+    while (hi - lo > 1) {
+        uint64_t mid   = lo + (hi - lo) / 2;
+        uint64_t zeros = mid * s_block * 64 - m_ranks[mid];
+        if (zeros <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    k -= lo * s_block * 64 - m_ranks[lo];
+
+    uint64_t w = lo * s_block;
+    for (;; ++w) {
+        uint64_t zeros = 64 - __builtin_popcountll(m_bits[w]);
+        if (k < zeros)
+            break;
+        k -= zeros;
+    }
+
+    uint64_t x = ~m_bits[w];
+    for (; k != 0; --k)
+        x &= x - 1;
+
+    return w * 64 + __builtin_ctzll(x);
+}
+
+inline uint64_t BitRank::words(uint64_t size) {
+    return (size + 63) / 64;
+}
+
+inline uint64_t BitRank::blocks(uint64_t size) {
+    return (words(size) + s_block - 1) / s_block + 1;
+}
+
+inline void BitRank::build_ranks(const std::vector<uint64_t> &bits,
+        uint64_t size, std::vector<uint64_t> &ranks) {
+
+    ranks.assign(blocks(size), 0);
+
+    uint64_t rank = 0;
+    for (uint64_t w = 0; w < words(size); ++w) {
+        if (w % s_block == 0)
+            ranks[w / s_block] = rank;
+        rank += __builtin_popcountll(bits[w]);
+    }
+
+    for (uint64_t b = (words(size) + s_block - 1) / s_block;
+            b < ranks.size(); ++b)
+        ranks[b] = rank;
+}
+
+/* Immutable LOUDS (level-order unary degree sequence) encoding of the
+ * r-way trie which is stored in a file and used directly from mapped
+ * memory.
+ *
+ * Nodes are numbered in breadth first order, root is node 0. Tree
+ * shape is stored as bit vector "10" followed by "1...10" for every
+ * node, where amount of ones is amount of children. Children of node
+ * k are located between (k)'th and (k + 1)'th zeros and they have
+ * consecutive numbers starting from rank1 of their position. Label
+ * of the edge leading to node k is labels[k]. Labels of siblings
+ * are sorted, so child lookup is a binary search. One more bit
+ * vector marks nodes with values, values are stored densely in
+ * order of node numbers.
+ *
+ * The whole structure takes about 2 bits + 1 byte per node plus
+ * values, compared to 256 pointers per node of Trie<T>. Opening
+ * the file is a single mmap, pages are loaded lazily and shared
+ * between all processes using the same file.
+ *
+ * File layout, every section is aligned to 8 bytes:
+ *   header  - magic, amount of nodes, amount of values, sizeof(T)
+ *   louds   - tree shape bits (2n + 1) and rank directory
+ *   valued  - value marks (n bits) and rank directory
+ *   labels  - n bytes
+ *   values  - values in node order
+ */
+template <typename T>
+class FrozenTrie {
+    static_assert(std::is_trivially_copyable<T>::value,
+            "values of frozen trie are stored as raw bytes");
+
+    public:
+
+        FrozenTrie();
+        FrozenTrie(const FrozenTrie &) = delete;
+        FrozenTrie &operator= (const FrozenTrie &) = delete;
+       ~FrozenTrie();
+
+        /* Convert trie to LOUDS encoding and write it to the file. In
+         * case of success true is returned.
+         */
+        static bool freeze(const Trie<T> &trie, const std::string &fname);
+
+        /* Map file written by freeze. Previously mapped file (if any)
+         * is unmapped. In case of success true is returned.
+         */
+        bool open(const std::string &fname);
+
+        /* Unmap the file */
+        void close();
+
+        /* Same as Trie<T>::get */
+        std::pair<bool, T> get(const std::string &key) const;
+
+        /* Same as Trie<T>::contains */
+        bool contains(const std::string &key) const;
+
+        /* Same as Trie<T>::keys_with_prefix */
+        template <typename F>
+        void keys_with_prefix(const std::string &prefix, F func) const;
+
+        /* Same as Trie<T>::longest_prefix_of */
+        std::pair<bool, std::string> longest_prefix_of(
+                const std::string &query) const;
+
+    private:
+
+        /* Offsets of the file sections */
+        struct Layout {
+            uint64_t louds_bits;
+            uint64_t louds_ranks;
+            uint64_t valued_bits;
+            uint64_t valued_ranks;
+            uint64_t labels;
+            uint64_t values;
+            uint64_t size;
+        };
+
+        /* File header */
+        struct Header {
+            char     magic[8];
+            uint64_t nodes;
+            uint64_t values;
+            uint64_t value_size;
+        };
+
+        /* Compute offsets of the file sections */
+        static Layout layout(uint64_t nodes, uint64_t values);
+
+        /* Append bit to the bit vector of given size */
+        static void push_bit(std::vector<uint64_t> &bits, uint64_t &size,
+                bool bit);
+
+        /* Get range of node numbers [first, first + count) of
+         * children of node.
+         */
+        void children(uint64_t node, uint64_t &first,
+                uint64_t &count) const;
+
+        /* Find child of node with edge label c. In case of success
+         * true is returned and child number is stored in next.
+         */
+        bool child(uint64_t node, unsigned char c, uint64_t &next) const;
+
+        /* Find node which corresponds to key. In case of success true
+         * is returned and node number is stored in node.
+         */
+        bool find(const std::string &key, uint64_t &node) const;
+
+        /* Auxiliary method that is used in keys_with_prefix method
+         * implementation. It reports all keys of the sub-trie rooted
+         * at node. Buffer contains key of the node itself.
+         */
+        template <typename F>
+        void collect_impl(uint64_t node, std::string &buffer,
+                F &func) const;
+
+        /* Get value of the node which is known to have value */
+        const T &value(uint64_t node) const;
+
+        /* Mapped file */
+        void   *m_addr;
+        size_t  m_length;
+
+        /* Views of the mapped file sections */
+        uint64_t              m_nodes;
+        BitRank               m_louds;
+        BitRank               m_valued;
+        const unsigned char  *m_labels;
+        const T              *m_values;
+
+        static const char s_magic[8];
+};
+
+template <typename T>
+const char FrozenTrie<T>::s_magic[8] = {'L', 'O', 'U', 'D', 'S', 'T', 'R', '1'};
+
+template <typename T>
+FrozenTrie<T>::FrozenTrie()
+    :m_addr(NULL)
+    ,m_length(0)
+    ,m_nodes(0)
+    ,m_labels(NULL)
+    ,m_values(NULL)
+{}
+
+template <typename T>
+FrozenTrie<T>::~FrozenTrie() {
+    close();
+}
+
+template <typename T>
+typename FrozenTrie<T>::Layout FrozenTrie<T>::layout(uint64_t nodes,
+        uint64_t values) {
+
+    uint64_t louds = 2 * nodes + 1;
+    Layout l;
+    l.louds_bits   = sizeof(Header);
+    l.louds_ranks  = l.louds_bits   + BitRank::words(louds) * 8;
+    l.valued_bits  = l.louds_ranks  + BitRank::blocks(louds) * 8;
+    l.valued_ranks = l.valued_bits  + BitRank::words(nodes) * 8;
+    l.labels       = l.valued_ranks + BitRank::blocks(nodes) * 8;
+    l.values       = l.labels       + (nodes + 7) / 8 * 8;
+    l.size         = l.values       + (values * sizeof(T) + 7) / 8 * 8;
+    return l;
+}
+
+template <typename T>
+void FrozenTrie<T>::push_bit(std::vector<uint64_t> &bits, uint64_t &size,
+        bool bit) {
+    if (size % 64 == 0)
+        bits.push_back(0);
+    if (bit)
+        bits.back() |= uint64_t(1) << (size % 64);
+    ++size;
+}
+
+template <typename T>
+bool FrozenTrie<T>::freeze(const Trie<T> &trie, const std::string &fname) {
+
+    /* Breadth first traversal of the trie. Nodes vector is used as
+     * a queue, position in the vector is the node number.
+     */
+    Node<T> empty;
+    std::vector<const Node<T> *> nodes;
+    nodes.push_back(trie.root() != NULL ? trie.root() : &empty);
+
+    std::vector<uint64_t> louds;
+    std::vector<uint64_t> valued;
+    std::vector<unsigned char> labels(1, 0);
+    std::vector<T> values;
+    uint64_t louds_size  = 0;
+    uint64_t valued_size = 0;
+
+    push_bit(louds, louds_size, true);
+    push_bit(louds, louds_size, false);
+
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const Node<T> *node = nodes[i];
+
+        bool valid = node->m_value != Node<T>::s_invalid;
+        push_bit(valued, valued_size, valid);
+        if (valid)
+            values.push_back(node->m_value);
+
+        for (int c = 0; c < Node<T>::s_base; ++c) {
+            if (node->m_next[c] == NULL)
+                continue;
+
+            nodes.push_back(node->m_next[c]);
+            labels.push_back(static_cast<unsigned char>(c));
+            push_bit(louds, louds_size, true);
+        }
+
+        push_bit(louds, louds_size, false);
+    }
+
+    std::vector<uint64_t> louds_ranks;
+    std::vector<uint64_t> valued_ranks;
+    BitRank::build_ranks(louds, louds_size, louds_ranks);
+    BitRank::build_ranks(valued, valued_size, valued_ranks);
+
+    Header header;
+    memcpy(header.magic, s_magic, sizeof(header.magic));
+    header.nodes      = nodes.size();
+    header.values     = values.size();
+    header.value_size = sizeof(T);
+
+    /* Every section is written with padding up to its offset in the
+     * layout, so reader can compute offsets from the header only.
+     */
+    Layout l = layout(header.nodes, header.values);
+    std::vector<char> file(l.size, 0);
+    memcpy(&file[0], &header, sizeof(header));
+    memcpy(&file[l.louds_bits], louds.data(), louds.size() * 8);
+    memcpy(&file[l.louds_ranks], louds_ranks.data(), louds_ranks.size() * 8);
+    memcpy(&file[l.valued_bits], valued.data(), valued.size() * 8);
+    memcpy(&file[l.valued_ranks], valued_ranks.data(),
+            valued_ranks.size() * 8);
+    memcpy(&file[l.labels], labels.data(), labels.size());
+    if (!values.empty())
+        memcpy(&file[l.values], values.data(), values.size() * sizeof(T));
+
+    FILE *fp = fopen(fname.c_str(), "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "%s: fopen(%s) error\n", __func__, fname.c_str());
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        return false;
+    }
+
+    if (fwrite(file.data(), file.size(), 1, fp) != 1) {
+        fprintf(stderr, "%s: fwrite error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        fclose(fp);
+        return false;
+    }
+
+    if (fclose(fp) != 0) {
+        fprintf(stderr, "%s: fclose error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+bool FrozenTrie<T>::open(const std::string &fname) {
+    close();
+
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: open(%s) error\n", __func__, fname.c_str());
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "%s: fstat error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    if ((size_t)st.st_size < sizeof(Header)) {
+        fprintf(stderr, "%s: file is too short\n", __func__);
+        ::close(fd);
+        return false;
+    }
+
+    void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        return false;
+    }
+
+    m_addr   = addr;
+    m_length = st.st_size;
+
+    const Header *header = static_cast<const Header *>(m_addr);
+    if (memcmp(header->magic, s_magic, sizeof(s_magic)) != 0) {
+        fprintf(stderr, "%s: unexpected magic\n", __func__);
+        close();
+        return false;
+    }
+
+    if (header->value_size != sizeof(T)) {
+        fprintf(stderr, "%s: unexpected value size\n", __func__);
+        fprintf(stderr, "%s: expected %zu\n", __func__, sizeof(T));
+        fprintf(stderr, "%s: really %llu\n", __func__,
+                (unsigned long long)header->value_size);
+        close();
+        return false;
+    }
+
+    Layout l = layout(header->nodes, header->values);
+    if (header->nodes == 0 || l.size > m_length) {
+        fprintf(stderr, "%s: file is too short\n", __func__);
+        close();
+        return false;
+    }
+
+    const char *base = static_cast<const char *>(m_addr);
+    m_nodes  = header->nodes;
+    m_louds.assign(
+            reinterpret_cast<const uint64_t *>(base + l.louds_bits),
+            reinterpret_cast<const uint64_t *>(base + l.louds_ranks),
+            2 * m_nodes + 1);
+    m_valued.assign(
+            reinterpret_cast<const uint64_t *>(base + l.valued_bits),
+            reinterpret_cast<const uint64_t *>(base + l.valued_ranks),
+            m_nodes);
+    m_labels = reinterpret_cast<const unsigned char *>(base + l.labels);
+    m_values = reinterpret_cast<const T *>(base + l.values);
+    return true;
+}
+
+template <typename T>
+void FrozenTrie<T>::close() {
+    if (m_addr != NULL)
+        munmap(m_addr, m_length);
+
+    m_addr   = NULL;
+    m_length = 0;
+    m_nodes  = 0;
+    m_labels = NULL;
+    m_values = NULL;
+}
+
+template <typename T>
+void FrozenTrie<T>::children(uint64_t node, uint64_t &first,
+        uint64_t &count) const {
+    uint64_t begin = m_louds.select0(node) + 1;
+    uint64_t end   = m_louds.select0(node + 1);
+    first = m_louds.rank1(begin);
+    count = end - begin;
+}
+
+template <typename T>
+bool FrozenTrie<T>::child(uint64_t node, unsigned char c,
+        uint64_t &next) const {
+    uint64_t first, count;
+    children(node, first, count);
+
+    const unsigned char *begin = m_labels + first;
+    const unsigned char *end   = begin + count;
+    const unsigned char *it    = std::lower_bound(begin, end, c);
+    if (it == end || *it != c)
+        return false;
+
+    next = first + (it - begin);
+    return true;
+}
+
+template <typename T>
+bool FrozenTrie<T>::find(const std::string &key, uint64_t &node) const {
+    if (m_nodes == 0)
+        return false;
+
+    node = 0;
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        if (!child(node, static_cast<unsigned char>(key[i]), node))
+            return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+const T &FrozenTrie<T>::value(uint64_t node) const {
+    return m_values[m_valued.rank1(node)];
+}
+
+template <typename T>
+std::pair<bool, T> FrozenTrie<T>::get(const std::string &key) const {
+    uint64_t node;
+    if (!find(key, node) || !m_valued.get(node))
+        return std::make_pair(false, T());
+
+    return std::make_pair(true, value(node));
+}
+
+template <typename T>
+bool FrozenTrie<T>::contains(const std::string &key) const {
+    uint64_t node;
+    return find(key, node) && m_valued.get(node);
+}
+
+template <typename T>
+template <typename F>
+void FrozenTrie<T>::keys_with_prefix(const std::string &prefix,
+        F func) const {
+    uint64_t node;
+    if (!find(prefix, node))
+        return;
+
+    std::string buffer(prefix);
+    collect_impl(node, buffer, func);
+}
+
+template <typename T>
+template <typename F>
+void FrozenTrie<T>::collect_impl(uint64_t node, std::string &buffer,
+        F &func) const {
+
+    if (m_valued.get(node))
+        func(static_cast<const std::string &>(buffer), value(node));
+
+    uint64_t first, count;
+    children(node, first, count);
+
+    for (uint64_t i = first; i < first + count; ++i) {
+        buffer.push_back(static_cast<char>(m_labels[i]));
+        collect_impl(i, buffer, func);
+        buffer.pop_back();
+    }
+}
+
+template <typename T>
+std::pair<bool, std::string> FrozenTrie<T>::longest_prefix_of(
+        const std::string &query) const {
+
+    bool found = false;
+    std::size_t length = 0;
+    if (m_nodes == 0)
+        return std::make_pair(false, std::string());
+
+    uint64_t node = 0;
+    for (std::size_t depth = 0;; ++depth) {
+        if (m_valued.get(node)) {
+            found  = true;
+            length = depth;
+        }
+
+        if (depth == query.size())
+            break;
+
+        if (!child(node, static_cast<unsigned char>(query[depth]), node))
+            break;
+    }
+
+    return std::make_pair(found, query.substr(0, found ? length : 0));
+}
+
+#endif  /* _TRIES_R_WAY_FROZEN_TRIE_H */
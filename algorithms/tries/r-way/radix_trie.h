@@ -0,0 +1,277 @@
+#ifndef _TRIES_R_WAY_RADIX_TRIE_H
+#define _TRIES_R_WAY_RADIX_TRIE_H
+
+#include <string.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../common/key_arena.h"
+
+/* Node of path compressed r-way trie. In addition to the links and
+ * value of ordinary node it keeps label of the edge which leads to
+ * the node from its parent. Label is a reference into the key arena
+ * of the trie. Root node has empty label.
+ */
+template <typename T>
+class RadixNode {
+    public:
+
+        RadixNode();
+        RadixNode(const RadixNode &) = delete;
+        RadixNode &operator= (const RadixNode &) = delete;
+       ~RadixNode();
+
+        /* Set of child nodes indexed by the first byte of their
+         * labels.
+         */
+        std::vector<RadixNode *> m_next;
+
+        /* Label of the edge from parent */
+        Label m_label;
+
+        /* Node's value */
+        T m_value;
+
+        static const int s_base = 256;
+        static const T s_invalid = T();
+};
+
+template <typename T>
+RadixNode<T>::RadixNode()
+    :m_next(std::vector<RadixNode *>(s_base, NULL))
+    ,m_label(Label{0, 0})
+    ,m_value(s_invalid)
+{}
+
+template <typename T>
+RadixNode<T>::~RadixNode() {
+    for (RadixNode *next: m_next)
+        delete next;
+}
+
+/* R-way trie in radix (Patricia) mode. Chain of nodes with single
+ * child and no value is collapsed into one node with multi byte edge
+ * label, so every node except the root has either value or at least
+ * two children. Amount of nodes and lookup hops is bounded by amount
+ * of keys instead of total length of keys, which matters for keys
+ * with long shared or unique stretches like URLs and file paths.
+ */
+template <typename T>
+class RadixTrie {
+    public:
+
+        RadixTrie();
+        RadixTrie(const RadixTrie &) = delete;
+        RadixTrie &operator= (const RadixTrie &) = delete;
+       ~RadixTrie();
+
+        /* Same as Trie<T>::insert */
+        void insert(const std::string &key, const T &value);
+
+        /* Same as Trie<T>::get */
+        std::pair<bool, T> get(const std::string &key) const;
+
+        /* Same as Trie<T>::contains */
+        bool contains(const std::string &key) const;
+
+        /* Same as Trie<T>::erase */
+        void erase(const std::string &key);
+
+    private:
+
+        typedef RadixNode<T> Node;
+
+        /* Length of common prefix of label and key suffix starting
+         * at position pos.
+         */
+        std::size_t match(const Label &label, const std::string &key,
+                std::size_t pos) const;
+
+        /* Split label of node after i bytes. It returns new node
+         * which takes the first part of label and has node as the
+         * only child.
+         */
+        Node *split(Node *node, std::size_t i);
+
+        /* Auxiliary method that is used in erase method
+         * implementation. Node label starts at position pos of key.
+         * It returns updated version of node: NULL if node is erased
+         * or its only child if node is merged with it.
+         */
+        Node *erase_impl(Node *node, const std::string &key,
+                std::size_t pos);
+
+        /* Restore invariant of non root node after erase. Node
+         * without value and children is deleted, node without value
+         * and with single child is merged with the child.
+         */
+        Node *compact(Node *node);
+
+        /* Root node of trie */
+        Node *m_root;
+
+        /* Storage of edge labels */
+        KeyArena m_arena;
+};
+
+template <typename T>
+RadixTrie<T>::RadixTrie()
+    :m_root(new Node())
+{}
+
+template <typename T>
+RadixTrie<T>::~RadixTrie() {
+    delete m_root;
+}
+
+template <typename T>
+std::size_t RadixTrie<T>::match(const Label &label,
+        const std::string &key, std::size_t pos) const {
+    const char *data = m_arena.data(label);
+    std::size_t n = std::min(label.length, key.size() - pos);
+    std::size_t i = 0;
+    while (i < n && data[i] == key[pos + i])
+        ++i;
+
+    return i;
+}
+
+template <typename T>
+RadixNode<T> *RadixTrie<T>::split(Node *node, std::size_t i) {
+    Node *head = new Node();
+    head->m_label = Label{node->m_label.offset, i};
+    node->m_label = Label{node->m_label.offset + i, node->m_label.length - i};
+
+    unsigned char c = *m_arena.data(node->m_label);
+    head->m_next[c] = node;
+    return head;
+}
+
+template <typename T>
+void RadixTrie<T>::insert(const std::string &key, const T &value) {
+    Node *node = m_root;
+    std::size_t pos = 0;
+
+    while (pos < key.size()) {
+        unsigned char c = key[pos];
+        Node *next = node->m_next[c];
+
+        /* The rest of the key becomes label of a new leaf */
+        if (next == NULL) {
+            next = new Node();
+            next->m_label = m_arena.append(key.data() + pos, key.size() - pos);
+            next->m_value = value;
+            node->m_next[c] = next;
+            return;
+        }
+
+        /* Key diverges from the label (or ends) in the middle of the
+         * edge, so the edge is split at that point.
+         */
+        std::size_t i = match(next->m_label, key, pos);
+        if (i < next->m_label.length) {
+            next = split(next, i);
+            node->m_next[c] = next;
+        }
+
+        node = next;
+        pos += i;
+    }
+
+    node->m_value = value;
+}
+
+template <typename T>
+std::pair<bool, T> RadixTrie<T>::get(const std::string &key) const {
+    const Node *node = m_root;
+    std::size_t pos = 0;
+
+    while (pos < key.size()) {
+        unsigned char c = key[pos];
+        node = node->m_next[c];
+        if (node == NULL)
+            return std::make_pair(false, T());
+
+        std::size_t length = node->m_label.length;
+        if (key.size() - pos < length ||
+            memcmp(m_arena.data(node->m_label), key.data() + pos, length) != 0)
+            return std::make_pair(false, T());
+
+        pos += length;
+    }
+
+    const T &value = node->m_value;
+    return std::make_pair(value != Node::s_invalid, value);
+}
+
+template <typename T>
+bool RadixTrie<T>::contains(const std::string &key) const {
+    return get(key).first;
+}
+
+template <typename T>
+void RadixTrie<T>::erase(const std::string &key) {
+    if (key.empty()) {
+        m_root->m_value = Node::s_invalid;
+        return;
+    }
+
+    unsigned char c = key[0];
+    m_root->m_next[c] = erase_impl(m_root->m_next[c], key, 0);
+}
+
+template <typename T>
+RadixNode<T> *RadixTrie<T>::erase_impl(Node *node,
+        const std::string &key, std::size_t pos) {
+
+    if (node == NULL)
+        return NULL;
+
+    std::size_t length = node->m_label.length;
+    if (match(node->m_label, key, pos) != length)
+        return node;
+
+    pos += length;
+    if (pos == key.size()) {
+        node->m_value = Node::s_invalid;
+    } else {
+        unsigned char c = key[pos];
+        node->m_next[c] = erase_impl(node->m_next[c], key, pos);
+    }
+
+    return compact(node);
+}
+
+template <typename T>
+RadixNode<T> *RadixTrie<T>::compact(Node *node) {
+    if (node->m_value != Node::s_invalid)
+        return node;
+
+    int count = 0;
+    int child = 0;
+    for (int c = 0; c < Node::s_base && count < 2; ++c) {
+        if (node->m_next[c] != NULL) {
+            ++count;
+            child = c;
+        }
+    }
+
+    if (count == 0) {
+        delete node;
+        return NULL;
+    }
+
+    if (count == 1) {
+        Node *next = node->m_next[child];
+        next->m_label = m_arena.join(node->m_label, next->m_label);
+        node->m_next[child] = NULL;
+        delete node;
+        return next;
+    }
+
+    return node;
+}
+
+#endif  /* _TRIES_R_WAY_RADIX_TRIE_H */
@@ -0,0 +1,871 @@
+
+#ifndef _TRIES_R_WAY_TRIE_H
+#define _TRIES_R_WAY_TRIE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <string>
+#include <utility>
+#include "../common/levenshtein.h"
+
+/* Node of r-way trie. Each node contains optional value and links to
+ * next 256 nodes which correspond to all possible next characters in
+ * the stored string.
+ */
+template <typename T>
+class Node {
+    public:
+
+        Node();
+        Node(const Node &) = delete;
+        Node &operator= (const Node &) = delete;
+       ~Node();
+
+        /* Set of child nodes */
+        std::vector<Node *> m_next;
+
+        /* Node's value */
+        T m_value;
+
+        /* Maximum value stored in the sub-trie rooted at this node
+         * (including the node itself). It is used by autocomplete to
+         * visit the most promising sub-tries first and to skip the
+         * rest. The field is meaningless for an empty root.
+         */
+        T m_max;
+
+        /* Amount of all possible characters in the trie. Here we
+         * assume that we are dealing with extended ASCII alphabet. 
+         */
+        static const int s_base = 256;
+        static const T s_invalid = T();
+};
+
+template <typename T>
+Node<T>::Node()
+    :m_next(std::vector<Node *>(s_base, NULL))
+    ,m_value(s_invalid)
+    ,m_max(s_invalid)
+{}
+
+template <typename T>
+static inline void delete_node(Node<T> *node) {
+    delete node;
+}
+
+template <typename T>
+Node<T>::~Node() {
+    std::for_each(m_next.begin(), m_next.end(), delete_node<T>);
+}
+
+template <typename T>
+class Trie {
+    public:
+        
+        Trie();
+        Trie(const Trie &) = delete;
+        Trie &operator= (const Trie &) = delete;
+       ~Trie();
+
+        /* Insert pair (key, value) into the trie. Procedure will
+         * create new node if node with suceh key doesn't exist. 
+         * Otherwise it will update value for provided key. 
+         */
+        void insert(const std::string &key, const T &value);
+
+        /* Get value that corresponds to key in arguments. There are
+         * different ways to design signature of this method. Most
+         * nice one with const T& return value. But this signature
+         * requires std::out_of_range exception thrown in case if no
+         * such key in the trie. 
+         */
+        std::pair<bool, T> get(const std::string &key) const;
+        
+        /* Check if key is in the trie */
+        bool contains(const std::string &key) const;
+
+        /* Erase element with key from the trie */
+        void erase(const std::string &key);
+
+        /* Build the trie from range of (key, value) pairs sorted by
+         * key. Keys are processed in one pass: nodes on the common
+         * prefix of adjacent keys are reused from the path of the
+         * previous key, so nothing is walked from the root again.
+         * Sub-tries of different first characters are independent
+         * and are built in parallel by threads (0 means amount of
+         * hardware threads). If the trie is not empty or the range is
+         * not sorted then pairs are inserted one by one.
+         */
+        template <typename It>
+        void bulk_load(It first, It last, unsigned threads = 0);
+
+        /* Call func(key, value) for every key in the trie that starts
+         * with prefix. Keys are reported in lexicographic order. The
+         * key passed to func is a reference to an internal buffer that
+         * is reused between calls, so func has to copy it if it wants
+         * to keep it.
+         */
+        template <typename F>
+        void keys_with_prefix(const std::string &prefix, F func) const;
+
+        /* Get the longest key in the trie which is a prefix of query.
+         * The first element of the returned pair is false if there is
+         * no such key.
+         */
+        std::pair<bool, std::string> longest_prefix_of(
+                const std::string &query) const;
+
+        /* Call func(key, value) for at most k keys that start with
+         * prefix and have the largest values, in order of decreasing
+         * value. Sub-tries are visited best first using the m_max
+         * annotation, so only the nodes on the way to the reported
+         * keys (and their siblings) are ever touched. As in
+         * keys_with_prefix the key buffer is reused between calls.
+         */
+        template <typename F>
+        void autocomplete(const std::string &prefix, std::size_t k,
+                F func) const;
+
+        /* Call func(key, value, distance) for every key in the trie
+         * within Levenshtein distance k from query. Trie is walked
+         * depth first with a row of the DP table for every node on
+         * the path, sub-tries where the whole row exceeds k are not
+         * visited. Keys are reported in lexicographic order, key
+         * buffer is reused between calls as in keys_with_prefix.
+         */
+        template <typename F>
+        void fuzzy_search(const std::string &query, int k, F func) const;
+
+        /* Call func(key, value) for every key in range [lo, hi) in
+         * lexicographic order. It's a TrieCursor seek followed by a
+         * sequence of next calls, key buffer is reused between calls
+         * as in keys_with_prefix.
+         */
+        template <typename F>
+        void range(const std::string &lo, const std::string &hi,
+                F func) const;
+
+        /* Get root node of the trie. It's used by the code that
+         * converts trie to other representations (see frozen_trie.h).
+         * Returned value may be NULL for empty trie.
+         */
+        const Node<T> *root() const;
+        
+    private:
+
+        /* Auxilliary method that is used in the insert method
+         * implementation. It returns updated version of the node
+         * (object in arguments) that is located at the level (depth)
+         * of trie in result of insertion pair (key, value). Levels
+         * numeration starting from 0 for root and grows down. Flag
+         * grow is set to false if value of existing key decreases.
+         */
+        Node<T> *insert_impl(Node<T> *node, const std::string &key,
+                const T &value, int depth, bool &grow);
+
+        /* Auxiliary method that is used in erase method
+         * implementation. It returns updated version of the node in
+         * lower level of trie. NULL value for erased node and not
+         * NULL value for other nodes.
+         */
+        Node<T> *erase_impl(Node<T> *node, const std::string &key,
+                int depth);
+
+        /* Auxiliary method that is used in get method implementation.
+         * It returns node that corresponds to key in arguments. 
+         * Otherwise it returns NULL. 
+         */
+        const Node<T> *get_impl(const Node<T> *node,
+                const std::string &key, int depth) const;
+
+        /* Auxiliary method that is used in keys_with_prefix method
+         * implementation. It reports all keys of the sub-trie rooted
+         * at node. Buffer contains key of the node itself.
+         */
+        template <typename F>
+        void collect_impl(const Node<T> *node, std::string &buffer,
+                F &func) const;
+
+        /* Auxiliary method that is used in fuzzy_search method
+         * implementation. It reports keys of the sub-trie rooted at
+         * node which is located at depth. Rows contain DP rows of all
+         * nodes on the path, buffer contains key of the node.
+         */
+        template <typename F>
+        void fuzzy_impl(const Node<T> *node, const std::string &query,
+                int k, std::size_t depth, std::vector<int> &rows,
+                std::string &buffer, F &func) const;
+
+        /* Auxiliary method that is used in bulk_load method
+         * implementation. It builds sub-trie for non empty sorted
+         * keys with the same first character and returns its root
+         * (node of the first character).
+         */
+        template <typename It>
+        Node<T> *bulk_load_impl(It first, It last) const;
+
+        /* Auxiliary method that is used in bulk_load method
+         * implementation. Node from the top of path is complete, its
+         * m_max is finalized and added to m_max of its parent.
+         */
+        void pop_path(std::vector<Node<T> *> &path) const;
+
+        /* Recompute m_max of node from its own value and m_max of its
+         * children.
+         */
+        void update_max(Node<T> *node) const;
+
+        /* Is m_max of node less than value? Empty node has no m_max
+         * so it's less than any value.
+         */
+        bool less_max(const Node<T> *node, const T &value) const;
+
+        /* Is node from arguments leaf node? */
+        bool leaf_node(const Node<T> *node) const;
+
+        /* Root node of trie */
+        Node<T> *m_root;
+};
+
+template <typename T>
+Trie<T>::Trie()
+    :m_root(new Node<T>())
+{}
+
+template <typename T>
+Trie<T>::~Trie() {
+    delete m_root;
+}
+
+template <typename T>
+const Node<T> *Trie<T>::root() const {
+    return m_root;
+}
+
+template <typename T>
+void Trie<T>::insert(const std::string &key, const T &value) {
+    bool grow = true;
+    m_root = insert_impl(m_root, key, value, 0, grow);
+}
+
+template <typename T>
+void Trie<T>::update_max(Node<T> *node) const {
+    bool valid = node->m_value != Node<T>::s_invalid;
+    node->m_max = node->m_value;
+
+    for (const Node<T> *i: node->m_next) {
+        if (i == NULL)
+            continue;
+
+        if (!valid || node->m_max < i->m_max) {
+            node->m_max = i->m_max;
+            valid = true;
+        }
+    }
+}
+
+template <typename T>
+bool Trie<T>::less_max(const Node<T> *node, const T &value) const {
+    return node->m_max == Node<T>::s_invalid || node->m_max < value;
+}
+
+template <typename T>
+Node<T> *Trie<T>::insert_impl(Node<T> *node,
+    const std::string &key, const T &value, int depth, bool &grow) { 
+
+    bool fresh = node == NULL;
+    if (fresh)
+        node = new Node<T>();
+
+    /* Keep m_max annotation up to date on the way back to the root.
+     * If value of the key grows (or key is new) then it's enough to
+     * raise m_max of every node on the path. Otherwise m_max of the
+     * node may come from the old value and it has to be recomputed
+     * from the children.
+     */
+    if (depth == key.size()) {
+        const T old = node->m_value;
+        grow = old == Node<T>::s_invalid || !(value < old);
+        node->m_value = value;
+
+        if (fresh || (grow && less_max(node, value)))
+            node->m_max = value;
+        else if (!grow)
+            update_max(node);
+
+        return node;
+    }
+
+    unsigned char c = key[depth];
+    Node<T> *next   = node->m_next[c];
+    node->m_next[c] = insert_impl(next, key, value, depth + 1, grow); 
+
+    const T &max = node->m_next[c]->m_max;
+    if (fresh || (grow && less_max(node, max)))
+        node->m_max = max;
+    else if (!grow)
+        update_max(node);
+
+    return node;
+}
+
+template <typename T>
+bool Trie<T>::contains(const std::string &key) const {
+    std::pair<bool, T> value = get(key);
+    return value.first;
+}
+
+template <typename T>
+std::pair<bool, T> Trie<T>::get(const std::string &key) const {
+    const Node<T> *node = get_impl(m_root, key, 0);
+
+    if (node == NULL)
+        return std::make_pair(false, T());
+
+    const T &value = node->m_value; 
+    return std::make_pair(value != Node<T>::s_invalid, value);
+}
+
+template <typename T>
+const Node<T> *Trie<T>::get_impl(const Node<T> *node,
+        const std::string &key, int depth) const {
+
+    if (node == NULL)
+        return  NULL;
+
+    if (depth == key.size())
+        return node;
+
+    unsigned char c = key[depth];
+    return get_impl(node->m_next[c], key, depth + 1);
+}
+
+template <typename T>
+void Trie<T>::erase(const std::string &key) {
+    m_root = erase_impl(m_root, key, 0);
+}
+
+template <typename T>
+Node<T> *Trie<T>::erase_impl(Node<T> *node,
+        const std::string &key, int depth) {
+
+    /* If there is no such node which corresponds to key in the trie
+     * then there is no node to delete.
+     */
+    if (node == NULL)
+        return  NULL;
+
+    /* We found node corresponding to key. Mark it as intermediate. If
+     * it is a leaf node (there are no other keys for which path goes
+     * through this node) then it can be erased.
+     */
+    if (depth == key.size()) {
+        if (node->m_value == Node<T>::s_invalid)
+            return node;
+
+        node->m_value  = Node<T>::s_invalid;
+
+        if (leaf_node(node)) {
+            delete node;
+            return NULL;
+        }
+
+        update_max(node);
+        return node;
+    }
+
+    unsigned char c = key[depth];
+    node->m_next[c] = erase_impl(node->m_next[c], key, depth + 1);
+
+    /* Clean up all other leaf intermediate nodes on the way back from
+     * erased node to the root.
+     */
+    if (leaf_node(node) &&
+        node->m_value == Node<T>::s_invalid) {
+        delete node;
+        return NULL;
+    }
+        
+    update_max(node);
+    return node;
+}
+
+template <typename T>
+bool Trie<T>::leaf_node(const Node<T> *node) const {
+    for (const Node<T> *i: node->m_next) {
+        if (i != NULL) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+template <typename It>
+void Trie<T>::bulk_load(It first, It last, unsigned threads) {
+    typedef typename std::iterator_traits<It>::value_type pair_type;
+
+    bool empty = m_root == NULL ||
+        (leaf_node(m_root) && m_root->m_value == Node<T>::s_invalid);
+    bool sorted = std::is_sorted(first, last,
+            [](const pair_type &a, const pair_type &b) {
+                return a.first < b.first;
+            });
+
+    if (!empty || !sorted) {
+        for (It i = first; i != last; ++i)
+            insert(i->first, i->second);
+        return;
+    }
+
+    if (m_root == NULL)
+        m_root = new Node<T>();
+
+    /* Empty key (if any) goes first in sorted range */
+    for (; first != last && first->first.empty(); ++first)
+        m_root->m_value = first->second;
+
+    /* Split range into groups of keys with the same first character.
+     * Groups are handed out to threads largest first.
+     */
+    std::vector<std::pair<It, It>> groups;
+    for (It i = first; i != last;) {
+        It j = i;
+        while (j != last && j->first[0] == i->first[0])
+            ++j;
+        groups.push_back(std::make_pair(i, j));
+        i = j;
+    }
+
+    std::sort(groups.begin(), groups.end(),
+            [](const std::pair<It, It> &a, const std::pair<It, It> &b) {
+                return a.second - a.first > b.second - b.first;
+            });
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<std::size_t>(threads, groups.size());
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [this, &groups, &next]() {
+        for (;;) {
+            std::size_t i = next.fetch_add(1);
+            if (i >= groups.size())
+                return;
+
+            unsigned char c = groups[i].first->first[0];
+            m_root->m_next[c] =
+                bulk_load_impl(groups[i].first, groups[i].second);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread &thread: pool)
+        thread.join();
+
+    update_max(m_root);
+}
+
+template <typename T>
+template <typename It>
+Node<T> *Trie<T>::bulk_load_impl(It first, It last) const {
+
+    /* Path of the previous key: path[d] is the node of its first
+     * d + 1 characters. Nodes below the common prefix with the next
+     * key are complete when they are popped, because keys are
+     * sorted and no later key goes through them.
+     */
+    std::vector<Node<T> *> path;
+    Node<T> *top = new Node<T>();
+    path.push_back(top);
+
+    const std::string *prev = &first->first;
+    for (It i = first; i != last; ++i) {
+        const std::string &key = i->first;
+
+        std::size_t lcp = 1;
+        std::size_t n = std::min(key.size(), prev->size());
+        while (lcp < n && key[lcp] == (*prev)[lcp])
+            ++lcp;
+
+        while (path.size() > lcp)
+            pop_path(path);
+
+        for (std::size_t d = path.size(); d < key.size(); ++d) {
+            Node<T> *node = new Node<T>();
+            path.back()->m_next[(unsigned char)key[d]] = node;
+            path.push_back(node);
+        }
+
+        path.back()->m_value = i->second;
+        prev = &key;
+    }
+
+    while (!path.empty())
+        pop_path(path);
+
+    return top;
+}
+
+template <typename T>
+void Trie<T>::pop_path(std::vector<Node<T> *> &path) const {
+    Node<T> *node = path.back();
+    path.pop_back();
+
+    /* m_max already holds maximum of children */
+    const T &value = node->m_value;
+    if (value != Node<T>::s_invalid && less_max(node, value))
+        node->m_max = value;
+
+    if (!path.empty() && less_max(path.back(), node->m_max))
+        path.back()->m_max = node->m_max;
+}
+
+template <typename T>
+template <typename F>
+void Trie<T>::fuzzy_search(const std::string &query, int k,
+        F func) const {
+
+    if (m_root == NULL || k < 0)
+        return;
+
+    /* Minimum of the row at depth d is at least d - query.size(),
+     * so there is no need in rows deeper than query.size() + k.
+     */
+    std::size_t width = query.size() + 1;
+    std::vector<int> rows((query.size() + k + 1) * width);
+    for (std::size_t j = 0; j < width; ++j)
+        rows[j] = j;
+
+    std::string buffer;
+    fuzzy_impl(m_root, query, k, 0, rows, buffer, func);
+}
+
+template <typename T>
+template <typename F>
+void Trie<T>::fuzzy_impl(const Node<T> *node, const std::string &query,
+        int k, std::size_t depth, std::vector<int> &rows,
+        std::string &buffer, F &func) const {
+
+    std::size_t width = query.size() + 1;
+    const int *row = &rows[depth * width];
+
+    if (node->m_value != Node<T>::s_invalid && row[query.size()] <= k) {
+        func(static_cast<const std::string &>(buffer), node->m_value,
+                row[query.size()]);
+    }
+
+    if (depth == query.size() + k)
+        return;
+
+    int *next = &rows[(depth + 1) * width];
+    for (int c = 0; c < Node<T>::s_base; ++c) {
+        if (node->m_next[c] == NULL)
+            continue;
+
+        if (levenshtein_row(query, row, next, c) > k)
+            continue;
+
+        buffer.push_back(static_cast<char>(c));
+        fuzzy_impl(node->m_next[c], query, k, depth + 1, rows, buffer, func);
+        buffer.pop_back();
+    }
+}
+
+template <typename T>
+template <typename F>
+void Trie<T>::keys_with_prefix(const std::string &prefix, F func) const {
+    const Node<T> *node = get_impl(m_root, prefix, 0);
+    std::string buffer(prefix);
+    collect_impl(node, buffer, func);
+}
+
+template <typename T>
+template <typename F>
+void Trie<T>::collect_impl(const Node<T> *node, std::string &buffer,
+        F &func) const {
+
+    if (node == NULL)
+        return;
+
+    if (node->m_value != Node<T>::s_invalid)
+        func(static_cast<const std::string &>(buffer), node->m_value);
+
+    for (int c = 0; c < Node<T>::s_base; ++c) {
+        if (node->m_next[c] == NULL)
+            continue;
+
+        buffer.push_back(static_cast<char>(c));
+        collect_impl(node->m_next[c], buffer, func);
+        buffer.pop_back();
+    }
+}
+
+template <typename T>
+std::pair<bool, std::string> Trie<T>::longest_prefix_of(
+        const std::string &query) const {
+
+    /* Walk down the trie along query and remember depth of the last
+     * node with valid value.
+     */
+    const Node<T> *node = m_root;
+    bool found = false;
+    std::size_t length = 0;
+
+    for (std::size_t depth = 0; node != NULL; ++depth) {
+        if (node->m_value != Node<T>::s_invalid) {
+            found  = true;
+            length = depth;
+        }
+
+        if (depth == query.size())
+            break;
+
+        unsigned char c = query[depth];
+        node = node->m_next[c];
+    }
+
+    return std::make_pair(found, query.substr(0, found ? length : 0));
+}
+
+template <typename T>
+template <typename F>
+void Trie<T>::autocomplete(const std::string &prefix, std::size_t k,
+        F func) const {
+
+    const Node<T> *start = get_impl(m_root, prefix, 0);
+    if (start == NULL || k == 0)
+        return;
+
+    if (leaf_node(start) && start->m_value == Node<T>::s_invalid)
+        return;
+
+    /* Keys of the visited nodes are not materialized. Instead every
+     * visited node gets an entry in path table which refers to the
+     * entry of its parent and to the character on the edge between
+     * them. Key is rebuilt from the table only when it's reported.
+     * Entry with index 0 corresponds to the node of prefix.
+     */
+    struct Step {
+        std::size_t parent;
+        unsigned char c;
+    };
+
+    std::vector<Step> path(1, Step{0, 0});
+
+    /* Queue item is either a sub-trie with priority m_max or a key
+     * with priority equal to its value. Item with maximum priority
+     * is always taken first, so keys leave the queue in order of
+     * decreasing value.
+     */
+    struct Item {
+        T priority;
+        const Node<T> *node;
+        std::size_t step;
+        bool key;
+
+        bool operator< (const Item &other) const {
+            return priority < other.priority;
+        }
+    };
+
+    std::priority_queue<Item> queue;
+    queue.push(Item{start->m_max, start, 0, false});
+
+    std::string buffer;
+    std::size_t reported = 0;
+
+    while (!queue.empty() && reported < k) {
+        Item item = queue.top();
+        queue.pop();
+
+        if (item.key) {
+            buffer.clear();
+            for (std::size_t i = item.step; i != 0; i = path[i].parent)
+                buffer.push_back(static_cast<char>(path[i].c));
+
+            std::reverse(buffer.begin(), buffer.end());
+            buffer.insert(0, prefix);
+
+            func(static_cast<const std::string &>(buffer),
+                    item.node->m_value);
+            ++reported;
+            continue;
+        }
+
+        const Node<T> *node = item.node;
+        if (node->m_value != Node<T>::s_invalid)
+            queue.push(Item{node->m_value, node, item.step, true});
+
+        for (int c = 0; c < Node<T>::s_base; ++c) {
+            const Node<T> *next = node->m_next[c];
+            if (next == NULL)
+                continue;
+
+            path.push_back(Step{item.step, static_cast<unsigned char>(c)});
+            queue.push(Item{next->m_max, next, path.size() - 1, false});
+        }
+    }
+}
+
+/* Cursor which iterates keys of the trie in lexicographic order.
+ * Lexicographic order is pre-order of the trie, so the cursor keeps
+ * path from the root to the current node in explicit stack together
+ * with the next child to visit at every level, and the key of the
+ * current node in a single buffer. Moving to the next key doesn't
+ * allocate memory except for growth of the stack and buffer. Any
+ * modification of the trie invalidates the cursor.
+ */
+template <typename T>
+class TrieCursor {
+    public:
+
+        explicit TrieCursor(const Trie<T> &trie);
+
+        /* Position cursor at the smallest key */
+        void first();
+
+        /* Position cursor at the smallest key which is not less than
+         * lower bound.
+         */
+        void seek(const std::string &lower_bound);
+
+        /* Move cursor to the next key */
+        void next();
+
+        /* Is cursor positioned at some key? It's false when keys are
+         * exhausted.
+         */
+        bool valid() const;
+
+        /* Key and value at cursor. Cursor must be valid. */
+        const std::string &key() const;
+        const T &value() const;
+
+    private:
+
+        /* Level of the path: node and the first of its children
+         * which is not visited yet.
+         */
+        struct Frame {
+            const Node<T> *node;
+            int next;
+        };
+
+        /* Move to the next node with value in pre-order */
+        void advance();
+
+        const Trie<T> &m_trie;
+        std::vector<Frame> m_stack;
+        std::string m_key;
+};
+
+template <typename T>
+TrieCursor<T>::TrieCursor(const Trie<T> &trie)
+    :m_trie(trie)
+{}
+
+template <typename T>
+void TrieCursor<T>::first() {
+    seek(std::string());
+}
+
+template <typename T>
+void TrieCursor<T>::seek(const std::string &lower_bound) {
+    m_stack.clear();
+    m_key.clear();
+
+    if (m_trie.root() == NULL)
+        return;
+
+    m_stack.push_back(Frame{m_trie.root(), 0});
+
+    /* Walk down along lower bound. Every node on the way continues
+     * with children after the character of lower bound, they are
+     * greater than lower bound.
+     */
+    for (std::size_t depth = 0; depth < lower_bound.size(); ++depth) {
+        unsigned char c = lower_bound[depth];
+        Frame &frame = m_stack.back();
+        frame.next = c + 1;
+
+        const Node<T> *next = frame.node->m_next[c];
+        if (next == NULL) {
+            advance();
+            return;
+        }
+
+        m_stack.push_back(Frame{next, 0});
+        m_key.push_back(static_cast<char>(c));
+    }
+
+    if (m_stack.back().node->m_value == Node<T>::s_invalid)
+        advance();
+}
+
+template <typename T>
+void TrieCursor<T>::next() {
+    advance();
+}
+
+template <typename T>
+void TrieCursor<T>::advance() {
+    while (!m_stack.empty()) {
+        Frame &frame = m_stack.back();
+
+        int c = frame.next;
+        while (c < Node<T>::s_base && frame.node->m_next[c] == NULL)
+            ++c;
+
+        if (c == Node<T>::s_base) {
+            m_stack.pop_back();
+            if (!m_key.empty())
+                m_key.pop_back();
+            continue;
+        }
+
+        frame.next = c + 1;
+        const Node<T> *next = frame.node->m_next[c];
+        m_stack.push_back(Frame{next, 0});
+        m_key.push_back(static_cast<char>(c));
+
+        if (next->m_value != Node<T>::s_invalid)
+            return;
+    }
+}
+
+template <typename T>
+bool TrieCursor<T>::valid() const {
+    return !m_stack.empty();
+}
+
+template <typename T>
+const std::string &TrieCursor<T>::key() const {
+    return m_key;
+}
+
+template <typename T>
+const T &TrieCursor<T>::value() const {
+    return m_stack.back().node->m_value;
+}
+
+template <typename T>
+template <typename F>
+void Trie<T>::range(const std::string &lo, const std::string &hi,
+        F func) const {
+    TrieCursor<T> cursor(*this);
+    for (cursor.seek(lo); cursor.valid() && cursor.key() < hi;
+            cursor.next())
+        func(cursor.key(), cursor.value());
+}
+
+#endif  /* _TRIES_R_WAY_TRIE_H */
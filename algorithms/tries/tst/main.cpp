@@ -1,116 +1,64 @@
 
+
 #include <stdio.h>
 #include <string>
-
-/* Node of TST (Ternary Search Trie). Each node contains links to
- * right and left nodes and integer value. Value -1 is reserved for
- * invalid value.
- */
-class Node {
-    public:
-        Node();
-        Node(const Node &) = delete;
-        Node &operator= (const Node &) = delete;
-       ~Node();
-        
-        Node *m_lnode;
-        Node *m_rnode;
-        Node *m_nnode;
-        char  m_letter;
-        int   m_value;
-};
-
-Node::Node()
-    :m_lnode(NULL)
-    ,m_rnode(NULL)
-    ,m_nnode(NULL)
-    ,m_letter(0)
-    ,m_value(-1)
-{}
-
-Node::~Node() {
-    delete m_lnode;
-    delete m_rnode;
-    delete m_nnode;
-}
-
-class Tst {
-    public:
-        Tst();
-        Tst(const Tst &) = delete;
-        Tst &operator= (const Tst &) = delete;
-       ~Tst();
-
-        /* Insert pair (key, value) into the trie. Method will create
-         * new node if node with such key doesn't exist, otherwise it
-         * will update value for provided key.
-         */
-        void insert(const std::string &key, int val);
-
-        /* Erase node corresponding to key from the trie. If there is
-         * no node for provided key then do nothing.
-         */
-        void erase(const std::string &key);
-
-        /* Is trie contains node for given key? */
-        bool contains(const std::strin &key) const;
-
-        /* Get value of a node for given key. The first element of the
-         * returned pair is boolean flag. It has true value if there
-         * is node for provided key in the trie. Otherwise it has
-         * value false.
-         */
-        std::pair<bool, int> get(const std::string &key) const;
-
-    private:
-
-        /* Auxilliary procedure that is used in implementation of
-         * insert method. It returns pointer to sub-trie (node) at
-         * level (depth) with (key, value) pair inserted in it.
-         */
-        Node *insert_impl(Node *node, const std::string &key,
-                int val, int depth);
-
-        /* Root node of the trie */
-        Node *m_root;
-};
-
-Tst::Tst()
-    :m_root(NULL)
-{}
-
-Tst::~Tst() {
-    delete m_root;
-}
-
-void Tst::insert(const std::string &key, int val) {
-    m_root = insert_impl(m_root, key, val, 0);
-}
-
-Node *Tst::insert_impl(Node *node, const std::string &key,
-        int value, int depth) {
-
-    if (node == NULL) {
-        node = new Node();
-        node->m_letter = key[depth];
-    }
-
-    if (depth == key.size()) {
-        node->m_value = value;
-    } else if (key[depth] == node->m_letter) {
-        node->m_nnode = insert_impl(node->m_nnode, key, value, depth + 1);
-    } else if (key[depth] < node->m_letter) {
-        node->m_lnode = insert_impl(node->m_lnode, key, value, depth);
-    } else if (key[depth] > node->m_letter) {
-        node->m_rnode = insert_impl(node->m_rnode, key, value, depth);
-    }
-    
-    return node;
-}
+#include <utility>
+#include <vector>
+#include "tst.h"
+#include "radix_tst.h"
 
 int main(int argc, char *argv[]) {
 
+    Tst tst;
+    tst.insert("potato",   1);
+    tst.insert("pomidoro", 2);
+    tst.insert("carrot",   3);
+
+    tst.erase("pomidoro");
+    tst.erase("cabbage");
+    tst.erase("garlic");
+
+    printf("potato:   %d\n", tst.get("potato").second);
+    printf("pomidoro: %d\n", tst.get("pomidoro").second);
+    printf("carrot:   %d\n", tst.get("carrot").second);
+    printf("tomato:   %d\n", tst.get("tomato").second);
+
+    /* Balanced build of the hybrid trie from sorted keys */
+    std::vector<std::pair<std::string, int>> sorted;
+    sorted.push_back(std::make_pair("beet",     1));
+    sorted.push_back(std::make_pair("cabbage",  2));
+    sorted.push_back(std::make_pair("carrot",   3));
+    sorted.push_back(std::make_pair("garlic",   4));
+    sorted.push_back(std::make_pair("onion",    5));
+    sorted.push_back(std::make_pair("potato",   6));
+    sorted.push_back(std::make_pair("tomato",   7));
+
+    Tst hybrid(true);
+    hybrid.build(sorted);
+
+    printf("hybrid garlic: %d\n", hybrid.get("garlic").second);
+    printf("hybrid pepper: %d\n", hybrid.contains("pepper"));
+
+    printf("hybrid within distance 1 of 'carot':\n");
+    hybrid.fuzzy_search("carot", 1,
+            [](const std::string &key, int value, int distance) {
+        printf("    %s: %d (distance %d)\n", key.c_str(), value, distance);
+    });
+
+    printf("hybrid keys from 'c':\n");
+    TstCursor cursor(hybrid);
+    for (cursor.seek("c"); cursor.valid(); cursor.next())
+        printf("    %s: %d\n", cursor.key().c_str(), cursor.value());
+
+    /* Long shared prefixes are stored as single nodes */
+    RadixTst paths;
+    paths.insert("/usr/share/vegetables/potato", 1);
+    paths.insert("/usr/share/vegetables/carrot", 2);
+    paths.insert("/usr/share/fruits/apple",      3);
+    paths.erase("/usr/share/fruits/apple");
+
+    printf("radix carrot: %d\n",
+            paths.get("/usr/share/vegetables/carrot").second);
+    printf("radix apple:  %d\n", paths.contains("/usr/share/fruits/apple"));
     return 0;
 }
-
-
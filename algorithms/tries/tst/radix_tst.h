@@ -0,0 +1,317 @@
+#ifndef _TRIES_TST_RADIX_TST_H
+#define _TRIES_TST_RADIX_TST_H
+
+#include <string.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "../common/key_arena.h"
+#include "tst.h"
+
+/* Node of path compressed TST. Instead of single letter it keeps
+ * label of one or more bytes, which is a reference into the key
+ * arena of the trie. BST of every level is ordered by the first
+ * byte of labels, which is duplicated in m_letter, so BST descent
+ * doesn't touch the arena.
+ */
+class RadixTstNode {
+    public:
+        RadixTstNode();
+        RadixTstNode(const RadixTstNode &) = delete;
+        RadixTstNode &operator= (const RadixTstNode &) = delete;
+       ~RadixTstNode();
+
+        RadixTstNode  *m_lnode;
+        RadixTstNode  *m_rnode;
+        RadixTstNode  *m_nnode;
+        Label          m_label;
+        unsigned char  m_letter;
+        int            m_value;
+};
+
+inline RadixTstNode::RadixTstNode()
+    :m_lnode(NULL)
+    ,m_rnode(NULL)
+    ,m_nnode(NULL)
+    ,m_label(Label{0, 0})
+    ,m_letter(0)
+    ,m_value(TstNode::s_invalid)
+{}
+
+inline RadixTstNode::~RadixTstNode() {
+    delete m_lnode;
+    delete m_rnode;
+    delete m_nnode;
+}
+
+/* Ternary search trie in radix (Patricia) mode. Chain of nodes
+ * linked by middle links, where every node has no value and no BST
+ * siblings, is collapsed into one node with multi byte label. Middle
+ * link is followed only after the whole label is matched.
+ */
+class RadixTst {
+    public:
+        RadixTst();
+        RadixTst(const RadixTst &) = delete;
+        RadixTst &operator= (const RadixTst &) = delete;
+       ~RadixTst();
+
+        /* Same as Tst::insert */
+        void insert(const std::string &key, int val);
+
+        /* Same as Tst::erase */
+        void erase(const std::string &key);
+
+        /* Same as Tst::contains */
+        bool contains(const std::string &key) const;
+
+        /* Same as Tst::get */
+        std::pair<bool, int> get(const std::string &key) const;
+
+    private:
+
+        /* Length of common prefix of label and key suffix starting
+         * at position pos.
+         */
+        std::size_t match(const Label &label, const std::string &key,
+                std::size_t pos) const;
+
+        /* Split label of node after i bytes. Node keeps the first
+         * part of label and its BST links, new node with the rest of
+         * label takes value and middle link of node and becomes its
+         * middle link.
+         */
+        void split(RadixTstNode *node, std::size_t i);
+
+        /* Auxilliary procedure that is used in implementation of
+         * erase method. It returns pointer to sub-trie (node) with key
+         * erased from it.
+         */
+        RadixTstNode *erase_impl(RadixTstNode *node, const std::string &key,
+                std::size_t pos);
+
+        /* Restore invariants of node after erase. Node without value
+         * and middle link is removed from its BST, node without
+         * value and with single node middle BST is merged with it.
+         */
+        RadixTstNode *compact(RadixTstNode *node);
+
+        /* Remove node from BST of its level and return new root of
+         * the BST. Node must have no middle link and no value.
+         */
+        RadixTstNode *unlink_node(RadixTstNode *node);
+
+        /* Root node of the trie */
+        RadixTstNode *m_root;
+
+        /* Value of the empty key */
+        int m_empty;
+
+        /* Storage of labels */
+        KeyArena m_arena;
+};
+
+inline RadixTst::RadixTst()
+    :m_root(NULL)
+    ,m_empty(TstNode::s_invalid)
+{}
+
+inline RadixTst::~RadixTst() {
+    delete m_root;
+}
+
+inline std::size_t RadixTst::match(const Label &label,
+        const std::string &key, std::size_t pos) const {
+    const char *data = m_arena.data(label);
+    std::size_t n = std::min(label.length, key.size() - pos);
+    std::size_t i = 0;
+    while (i < n && data[i] == key[pos + i])
+        ++i;
+
+    return i;
+}
+
+inline void RadixTst::split(RadixTstNode *node, std::size_t i) {
+    RadixTstNode *tail = new RadixTstNode();
+    tail->m_label  = Label{node->m_label.offset + i, node->m_label.length - i};
+    tail->m_letter = *m_arena.data(tail->m_label);
+    tail->m_value  = node->m_value;
+    tail->m_nnode  = node->m_nnode;
+
+    node->m_label.length = i;
+    node->m_value = TstNode::s_invalid;
+    node->m_nnode = tail;
+}
+
+inline void RadixTst::insert(const std::string &key, int val) {
+    if (key.empty()) {
+        m_empty = val;
+        return;
+    }
+
+    RadixTstNode **link = &m_root;
+    std::size_t pos = 0;
+
+    for (;;) {
+        RadixTstNode *node = *link;
+        unsigned char c = key[pos];
+
+        /* The rest of the key becomes label of a new node */
+        if (node == NULL) {
+            node = new RadixTstNode();
+            node->m_label  = m_arena.append(key.data() + pos, key.size() - pos);
+            node->m_letter = c;
+            node->m_value  = val;
+            *link = node;
+            return;
+        }
+
+        if (c < node->m_letter) {
+            link = &node->m_lnode;
+        } else if (c > node->m_letter) {
+            link = &node->m_rnode;
+        } else {
+            std::size_t i = match(node->m_label, key, pos);
+            if (i < node->m_label.length)
+                split(node, i);
+
+            pos += i;
+            if (pos == key.size()) {
+                node->m_value = val;
+                return;
+            }
+
+            link = &node->m_nnode;
+        }
+    }
+}
+
+inline std::pair<bool, int> RadixTst::get(const std::string &key) const {
+    if (key.empty())
+        return std::make_pair(m_empty != TstNode::s_invalid, m_empty);
+
+    const RadixTstNode *node = m_root;
+    std::size_t pos = 0;
+
+    while (node != NULL) {
+        unsigned char c = key[pos];
+        if (c < node->m_letter) {
+            node = node->m_lnode;
+        } else if (c > node->m_letter) {
+            node = node->m_rnode;
+        } else {
+            std::size_t length = node->m_label.length;
+            if (key.size() - pos < length ||
+                memcmp(m_arena.data(node->m_label), key.data() + pos,
+                    length) != 0)
+                break;
+
+            pos += length;
+            if (pos == key.size()) {
+                if (node->m_value == TstNode::s_invalid)
+                    break;
+                return std::make_pair(true, node->m_value);
+            }
+
+            node = node->m_nnode;
+        }
+    }
+
+    return std::make_pair(false, (int)TstNode::s_invalid);
+}
+
+inline bool RadixTst::contains(const std::string &key) const {
+    return get(key).first;
+}
+
+inline void RadixTst::erase(const std::string &key) {
+    if (key.empty()) {
+        m_empty = TstNode::s_invalid;
+        return;
+    }
+
+    m_root = erase_impl(m_root, key, 0);
+}
+
+inline RadixTstNode *RadixTst::erase_impl(RadixTstNode *node,
+        const std::string &key, std::size_t pos) {
+
+    if (node == NULL)
+        return NULL;
+
+    unsigned char c = key[pos];
+    if (c < node->m_letter) {
+        node->m_lnode = erase_impl(node->m_lnode, key, pos);
+        return node;
+    } else if (c > node->m_letter) {
+        node->m_rnode = erase_impl(node->m_rnode, key, pos);
+        return node;
+    }
+
+    std::size_t length = node->m_label.length;
+    if (match(node->m_label, key, pos) != length)
+        return node;
+
+    pos += length;
+    if (pos == key.size())
+        node->m_value = TstNode::s_invalid;
+    else
+        node->m_nnode = erase_impl(node->m_nnode, key, pos);
+
+    return compact(node);
+}
+
+inline RadixTstNode *RadixTst::compact(RadixTstNode *node) {
+    if (node->m_value != TstNode::s_invalid)
+        return node;
+
+    if (node->m_nnode == NULL)
+        return unlink_node(node);
+
+    RadixTstNode *next = node->m_nnode;
+    if (next->m_lnode != NULL || next->m_rnode != NULL)
+        return node;
+
+    /* Middle BST is a single node, so it's a continuation of the
+     * node's label. It takes place of the node in the BST.
+     */
+    next->m_label  = m_arena.join(node->m_label, next->m_label);
+    next->m_letter = node->m_letter;
+    next->m_lnode  = node->m_lnode;
+    next->m_rnode  = node->m_rnode;
+
+    node->m_lnode = NULL;
+    node->m_rnode = NULL;
+    node->m_nnode = NULL;
+    delete node;
+    return next;
+}
+
+inline RadixTstNode *RadixTst::unlink_node(RadixTstNode *node) {
+    RadixTstNode *lnode = node->m_lnode;
+    RadixTstNode *rnode = node->m_rnode;
+    node->m_lnode = NULL;
+    node->m_rnode = NULL;
+    delete node;
+
+    if (lnode == NULL)
+        return rnode;
+    if (rnode == NULL)
+        return lnode;
+
+    /* Node has both children. Its place is taken by the minimum node
+     * of the right sub-tree.
+     */
+    RadixTstNode **link = &rnode;
+    while ((*link)->m_lnode != NULL)
+        link = &(*link)->m_lnode;
+
+    RadixTstNode *min = *link;
+    *link = min->m_rnode;
+    min->m_lnode = lnode;
+    min->m_rnode = rnode;
+    return min;
+}
+
+#endif  /* _TRIES_TST_RADIX_TST_H */
@@ -0,0 +1,792 @@
+#ifndef _TRIES_TST_TST_H
+#define _TRIES_TST_TST_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../common/levenshtein.h"
+
+/* Node of TST (Ternary Search Trie). Each node contains links to
+ * right and left nodes and integer value. Value -1 is reserved for
+ * invalid value.
+ */
+class TstNode {
+    public:
+        TstNode();
+        TstNode(const TstNode &) = delete;
+        TstNode &operator= (const TstNode &) = delete;
+       ~TstNode();
+
+        TstNode       *m_lnode;
+        TstNode       *m_rnode;
+        TstNode       *m_nnode;
+        unsigned char  m_letter;
+        int            m_value;
+
+        static const int s_invalid = -1;
+};
+
+inline TstNode::TstNode()
+    :m_lnode(NULL)
+    ,m_rnode(NULL)
+    ,m_nnode(NULL)
+    ,m_letter(0)
+    ,m_value(s_invalid)
+{}
+
+inline TstNode::~TstNode() {
+    delete m_lnode;
+    delete m_rnode;
+    delete m_nnode;
+}
+
+/* Ternary search trie. Optionally it's Sedgewick's hybrid with R^2
+ * branching at the root: keys of length 2 or more start in one of
+ * 65536 entries selected by their first two characters, so the two
+ * topmost (and largest) levels of BSTs are replaced by a single table
+ * lookup. Keys shorter than 2 characters stay in ordinary TST.
+ */
+class Tst {
+    public:
+        explicit Tst(bool wide_root = false);
+        Tst(const Tst &) = delete;
+        Tst &operator= (const Tst &) = delete;
+       ~Tst();
+
+        /* Insert pair (key, value) into the trie. Method will create
+         * new node if node with such key doesn't exist, otherwise it
+         * will update value for provided key.
+         */
+        void insert(const std::string &key, int val);
+
+        /* Insert all pairs (key, value) from the vector which is
+         * sorted by key. Keys are inserted in median order (middle
+         * key of the range first, then middle keys of both halves and
+         * so on), so every BST of the trie gets balanced instead of
+         * degenerating into a list as it happens with one by one
+         * insertion of sorted keys. Unsorted input is inserted
+         * correctly, but without balancing.
+         */
+        void build(const std::vector<std::pair<std::string, int>> &sorted);
+
+        /* Erase node corresponding to key from the trie. If there is
+         * no node for provided key then do nothing.
+         */
+        void erase(const std::string &key);
+
+        /* Is trie contains node for given key? */
+        bool contains(const std::string &key) const;
+
+        /* Get value of a node for given key. The first element of the
+         * returned pair is boolean flag. It has true value if there
+         * is node for provided key in the trie. Otherwise it has
+         * value false.
+         */
+        std::pair<bool, int> get(const std::string &key) const;
+
+        /* Call func(key, value, distance) for every key in the trie
+         * within Levenshtein distance k from query. Trie is walked
+         * depth first carrying a row of the DP table for every
+         * character of the current key prefix, middle links where
+         * the whole row exceeds k are not followed. Keys are reported
+         * in lexicographic order unless trie has wide root. The key
+         * passed to func is a reference to a buffer which is reused
+         * between calls.
+         */
+        template <typename F>
+        void fuzzy_search(const std::string &query, int k, F func) const;
+
+        /* Call func(key, value) for every key in range [lo, hi) in
+         * lexicographic order using TstCursor. The key passed to func
+         * is a reference to a buffer which is reused between calls.
+         */
+        template <typename F>
+        void range(const std::string &lo, const std::string &hi,
+                F func) const;
+
+    private:
+
+        friend class TstCursor;
+
+        /* Entry of the wide root. It keeps value of the key which
+         * consists of two characters of the entry and sub-trie of
+         * longer keys.
+         */
+        struct Slot {
+            TstNode *root;
+            int   value;
+        };
+
+        /* Auxilliary procedure that is used in implementation of
+         * insert method. It returns pointer to sub-trie (node) at
+         * level (depth) with (key, value) pair inserted in it.
+         */
+        TstNode *insert_impl(TstNode *node, const std::string &key,
+                int val, std::size_t depth);
+
+        /* Auxilliary procedure that is used in implementation of
+         * build method. It inserts pairs from range [lo, hi) in
+         * median order.
+         */
+        void build_impl(
+                const std::vector<std::pair<std::string, int>> &sorted,
+                std::size_t lo, std::size_t hi);
+
+        /* Auxilliary procedure that is used in implementation of
+         * erase method. It returns pointer to sub-trie (node) at
+         * level (depth) with key erased from it. Nodes which don't
+         * lead to any key anymore are removed from the trie.
+         */
+        TstNode *erase_impl(TstNode *node, const std::string &key,
+                std::size_t depth);
+
+        /* Remove node from BST of its level and return new root of
+         * the BST. Node must have no middle link and no value.
+         */
+        TstNode *unlink_node(TstNode *node);
+
+        /* Auxilliary procedure that is used in implementation of
+         * fuzzy_search method. It reports keys of BST rooted at node,
+         * which is located at depth. Rows contain DP rows of the key
+         * prefix, buffer contains the key prefix itself.
+         */
+        template <typename F>
+        void fuzzy_impl(const TstNode *node, const std::string &query,
+                int k, std::size_t depth, std::vector<int> &rows,
+                std::string &buffer, F &func) const;
+
+        /* Find node which corresponds to key. It returns NULL if
+         * there is no such node.
+         */
+        const TstNode *get_impl(const std::string &key) const;
+
+        /* Get entry of the wide root for key of length 2 or more.
+         * It returns NULL for other keys and if trie has no wide root.
+         */
+        Slot *root_slot(const std::string &key);
+        const Slot *root_slot(const std::string &key) const;
+
+        /* Root node of the trie */
+        TstNode *m_root;
+
+        /* Entries for keys of length 2 or more indexed by the first
+         * two characters. Empty unless trie has wide root.
+         */
+        std::vector<Slot> m_table;
+
+        /* Value of the empty key */
+        int m_empty;
+
+        /* Amount of entries at the wide root */
+        static const std::size_t s_table = 256 * 256;
+};
+
+inline Tst::Tst(bool wide_root)
+    :m_root(NULL)
+    ,m_table(wide_root ? s_table : 0, Slot{NULL, TstNode::s_invalid})
+    ,m_empty(TstNode::s_invalid)
+{}
+
+inline Tst::~Tst() {
+    delete m_root;
+    for (const Slot &slot: m_table)
+        delete slot.root;
+}
+
+inline Tst::Slot *Tst::root_slot(const std::string &key) {
+    if (m_table.empty() || key.size() < 2)
+        return NULL;
+
+    return &m_table[(unsigned char)key[0] * 256 + (unsigned char)key[1]];
+}
+
+inline const Tst::Slot *Tst::root_slot(const std::string &key) const {
+    return const_cast<Tst *>(this)->root_slot(key);
+}
+
+inline void Tst::insert(const std::string &key, int val) {
+    if (key.empty()) {
+        m_empty = val;
+        return;
+    }
+
+    Slot *slot = root_slot(key);
+    if (slot == NULL) {
+        m_root = insert_impl(m_root, key, val, 0);
+    } else if (key.size() == 2) {
+        slot->value = val;
+    } else {
+        slot->root = insert_impl(slot->root, key, val, 2);
+    }
+}
+
+inline TstNode *Tst::insert_impl(TstNode *node, const std::string &key,
+        int value, std::size_t depth) {
+
+    unsigned char c = key[depth];
+    if (node == NULL) {
+        node = new TstNode();
+        node->m_letter = c;
+    }
+
+    if (c < node->m_letter) {
+        node->m_lnode = insert_impl(node->m_lnode, key, value, depth);
+    } else if (c > node->m_letter) {
+        node->m_rnode = insert_impl(node->m_rnode, key, value, depth);
+    } else if (depth + 1 < key.size()) {
+        node->m_nnode = insert_impl(node->m_nnode, key, value, depth + 1);
+    } else {
+        node->m_value = value;
+    }
+
+    return node;
+}
+
+inline void Tst::build(
+        const std::vector<std::pair<std::string, int>> &sorted) {
+
+    if (m_table.empty()) {
+        build_impl(sorted, 0, sorted.size());
+        return;
+    }
+
+    /* Keys of the same entry of wide root are adjacent in sorted
+     * input, every such group is balanced on its own. Keys shorter
+     * than 2 have no entry and are interleaved with the groups, so
+     * they are collected and balanced together, otherwise every one
+     * of them would be a group of its own inserted in sorted order.
+     */
+    std::vector<std::pair<std::string, int>> rest;
+    std::size_t lo = 0;
+    while (lo < sorted.size()) {
+        const Slot *slot = root_slot(sorted[lo].first);
+        if (slot == NULL) {
+            rest.push_back(sorted[lo]);
+            ++lo;
+            continue;
+        }
+
+        std::size_t hi = lo + 1;
+        while (hi < sorted.size() && root_slot(sorted[hi].first) == slot)
+            ++hi;
+
+        build_impl(sorted, lo, hi);
+        lo = hi;
+    }
+
+    build_impl(rest, 0, rest.size());
+}
+
+inline void Tst::build_impl(
+        const std::vector<std::pair<std::string, int>> &sorted,
+        std::size_t lo, std::size_t hi) {
+
+    if (lo >= hi)
+        return;
+
+    std::size_t mid = lo + (hi - lo) / 2;
+    insert(sorted[mid].first, sorted[mid].second);
+    build_impl(sorted, lo, mid);
+    build_impl(sorted, mid + 1, hi);
+}
+
+inline const TstNode *Tst::get_impl(const std::string &key) const {
+    const Slot *slot = root_slot(key);
+    const TstNode *node = slot != NULL ? slot->root : m_root;
+    std::size_t depth = slot != NULL ? 2 : 0;
+
+    while (node != NULL) {
+        unsigned char c = key[depth];
+        if (c < node->m_letter) {
+            node = node->m_lnode;
+        } else if (c > node->m_letter) {
+            node = node->m_rnode;
+        } else if (depth + 1 < key.size()) {
+            node = node->m_nnode;
+            ++depth;
+        } else {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+inline std::pair<bool, int> Tst::get(const std::string &key) const {
+    if (key.empty())
+        return std::make_pair(m_empty != TstNode::s_invalid, m_empty);
+
+    const Slot *slot = root_slot(key);
+    if (slot != NULL && key.size() == 2)
+        return std::make_pair(slot->value != TstNode::s_invalid, slot->value);
+
+    const TstNode *node = get_impl(key);
+    if (node == NULL || node->m_value == TstNode::s_invalid)
+        return std::make_pair(false, (int)TstNode::s_invalid);
+
+    return std::make_pair(true, node->m_value);
+}
+
+inline bool Tst::contains(const std::string &key) const {
+    return get(key).first;
+}
+
+inline void Tst::erase(const std::string &key) {
+    if (key.empty()) {
+        m_empty = TstNode::s_invalid;
+        return;
+    }
+
+    Slot *slot = root_slot(key);
+    if (slot == NULL) {
+        m_root = erase_impl(m_root, key, 0);
+    } else if (key.size() == 2) {
+        slot->value = TstNode::s_invalid;
+    } else {
+        slot->root = erase_impl(slot->root, key, 2);
+    }
+}
+
+inline TstNode *Tst::erase_impl(TstNode *node, const std::string &key,
+        std::size_t depth) {
+
+    if (node == NULL)
+        return NULL;
+
+    unsigned char c = key[depth];
+    if (c < node->m_letter) {
+        node->m_lnode = erase_impl(node->m_lnode, key, depth);
+        return node;
+    } else if (c > node->m_letter) {
+        node->m_rnode = erase_impl(node->m_rnode, key, depth);
+        return node;
+    } else if (depth + 1 < key.size()) {
+        node->m_nnode = erase_impl(node->m_nnode, key, depth + 1);
+    } else {
+        node->m_value = TstNode::s_invalid;
+    }
+
+    /* Node which has no value and no middle link doesn't lead to any
+     * key anymore. It is removed from the BST of its level.
+     */
+    if (node->m_nnode == NULL && node->m_value == TstNode::s_invalid)
+        return unlink_node(node);
+
+    return node;
+}
+
+inline TstNode *Tst::unlink_node(TstNode *node) {
+    TstNode *lnode = node->m_lnode;
+    TstNode *rnode = node->m_rnode;
+    node->m_lnode = NULL;
+    node->m_rnode = NULL;
+    delete node;
+
+    if (lnode == NULL)
+        return rnode;
+    if (rnode == NULL)
+        return lnode;
+
+    /* Node has both children. Its place is taken by the minimum node
+     * of the right sub-tree.
+     */
+    TstNode **link = &rnode;
+    while ((*link)->m_lnode != NULL)
+        link = &(*link)->m_lnode;
+
+    TstNode *min = *link;
+    *link = min->m_rnode;
+    min->m_lnode = lnode;
+    min->m_rnode = rnode;
+    return min;
+}
+
+template <typename F>
+void Tst::fuzzy_search(const std::string &query, int k, F func) const {
+    if (k < 0)
+        return;
+
+    /* Minimum of the row at depth d is at least d - query.size(),
+     * so there is no need in rows deeper than query.size() + k.
+     */
+    std::size_t width = query.size() + 1;
+    std::size_t depth = query.size() + k;
+    std::vector<int> rows((depth + 1) * width);
+    for (std::size_t j = 0; j < width; ++j)
+        rows[j] = j;
+
+    std::string buffer;
+    if (m_empty != TstNode::s_invalid && (int)query.size() <= k)
+        func(static_cast<const std::string &>(buffer), m_empty,
+                (int)query.size());
+
+    fuzzy_impl(m_root, query, k, 0, rows, buffer, func);
+
+    if (m_table.empty() || depth < 2)
+        return;
+
+    /* Entries of the wide root are walked as two levels of 256-way
+     * trie, the first level is pruned as a whole.
+     */
+    int *row1 = &rows[width];
+    int *row2 = &rows[2 * width];
+    for (int c0 = 0; c0 < 256; ++c0) {
+        if (levenshtein_row(query, &rows[0], row1, c0) > k)
+            continue;
+
+        for (int c1 = 0; c1 < 256; ++c1) {
+            const Slot &slot = m_table[c0 * 256 + c1];
+            if (slot.root == NULL && slot.value == TstNode::s_invalid)
+                continue;
+
+            int min = levenshtein_row(query, row1, row2, c1);
+            if (min > k)
+                continue;
+
+            buffer.assign(1, static_cast<char>(c0));
+            buffer.push_back(static_cast<char>(c1));
+            if (slot.value != TstNode::s_invalid &&
+                row2[query.size()] <= k)
+                func(static_cast<const std::string &>(buffer), slot.value,
+                        row2[query.size()]);
+
+            fuzzy_impl(slot.root, query, k, 2, rows, buffer, func);
+        }
+    }
+}
+
+template <typename F>
+void Tst::fuzzy_impl(const TstNode *node, const std::string &query,
+        int k, std::size_t depth, std::vector<int> &rows,
+        std::string &buffer, F &func) const {
+
+    if (node == NULL)
+        return;
+
+    fuzzy_impl(node->m_lnode, query, k, depth, rows, buffer, func);
+
+    std::size_t width = query.size() + 1;
+    if (depth < query.size() + k) {
+        const int *row = &rows[depth * width];
+        int *next = &rows[(depth + 1) * width];
+        int min = levenshtein_row(query, row, next, node->m_letter);
+
+        buffer.push_back(static_cast<char>(node->m_letter));
+        if (node->m_value != TstNode::s_invalid && next[query.size()] <= k)
+            func(static_cast<const std::string &>(buffer), node->m_value,
+                    next[query.size()]);
+
+        if (min <= k)
+            fuzzy_impl(node->m_nnode, query, k, depth + 1, rows, buffer,
+                    func);
+        buffer.pop_back();
+    }
+
+    fuzzy_impl(node->m_rnode, query, k, depth, rows, buffer, func);
+}
+
+/* Cursor which iterates keys of the trie in lexicographic order.
+ * Lexicographic order is in-order traversal of TST (left BST, node
+ * itself, middle link, right BST), cursor keeps it in explicit stack
+ * of nodes with their depth and traversal state, and the key of the
+ * current node in a single buffer. Keys of the trie come from a
+ * sequence of sources: the empty key, and then either the root TST
+ * or (for wide root) for every first character: its one character
+ * key, and for every second character: two character key and TST of
+ * the entry. Any modification of the trie invalidates the cursor.
+ */
+class TstCursor {
+    public:
+
+        explicit TstCursor(const Tst &tst);
+
+        /* Position cursor at the smallest key */
+        void first();
+
+        /* Position cursor at the smallest key which is not less than
+         * lower bound.
+         */
+        void seek(const std::string &lower_bound);
+
+        /* Move cursor to the next key */
+        void next();
+
+        /* Is cursor positioned at some key? It's false when keys are
+         * exhausted.
+         */
+        bool valid() const;
+
+        /* Key and value at cursor. Cursor must be valid. */
+        const std::string &key() const;
+        int value() const;
+
+    private:
+
+        /* Node of the traversal with depth of its letter in the key
+         * and the next step to do with it.
+         */
+        struct Frame {
+            const TstNode *node;
+            std::size_t    depth;
+            int            state;
+        };
+
+        enum {
+            s_left,
+            s_self,
+            s_middle,
+            s_right
+        };
+
+        /* Move to the next key of the current or following sources */
+        void advance();
+
+        /* Continue traversal of the stack until the next node with
+         * value. It returns false if the stack is exhausted.
+         */
+        bool advance_stack();
+
+        /* Start source. It returns true if source is a single key
+         * which exists, TST sources only push their root.
+         */
+        bool open(std::size_t source);
+
+        /* Push nodes of TST rooted at node with keys not less than
+         * lower bound, so that advance_stack visits them in order.
+         */
+        void seek_stack(const TstNode *node, const std::string &lower_bound,
+                std::size_t depth);
+
+        /* Amount of sources */
+        std::size_t sources() const;
+
+        /* Sources per first character of wide root */
+        static const std::size_t s_per_char = 1 + 2 * 256;
+
+        const Tst &m_tst;
+        std::vector<Frame> m_stack;
+        std::string m_key;
+        int m_value;
+        bool m_valid;
+        std::size_t m_source;
+};
+
+inline TstCursor::TstCursor(const Tst &tst)
+    :m_tst(tst)
+    ,m_value(TstNode::s_invalid)
+    ,m_valid(false)
+    ,m_source(0)
+{}
+
+inline std::size_t TstCursor::sources() const {
+    return m_tst.m_table.empty() ? 2 : 1 + 256 * s_per_char;
+}
+
+inline bool TstCursor::open(std::size_t source) {
+    m_stack.clear();
+
+    if (source == 0) {
+        m_key.clear();
+        m_value = m_tst.m_empty;
+        return m_value != TstNode::s_invalid;
+    }
+
+    if (m_tst.m_table.empty()) {
+        m_key.clear();
+        if (m_tst.m_root != NULL)
+            m_stack.push_back(Frame{m_tst.m_root, 0, s_left});
+        return false;
+    }
+
+    std::size_t c0 = (source - 1) / s_per_char;
+    std::size_t j  = (source - 1) % s_per_char;
+    m_key.assign(1, static_cast<char>(c0));
+
+    if (j == 0) {
+        const TstNode *node = m_tst.get_impl(m_key);
+        if (node == NULL || node->m_value == TstNode::s_invalid)
+            return false;
+
+        m_value = node->m_value;
+        return true;
+    }
+
+    std::size_t c1 = (j - 1) / 2;
+    const Tst::Slot &slot = m_tst.m_table[c0 * 256 + c1];
+    m_key.push_back(static_cast<char>(c1));
+
+    if ((j - 1) % 2 == 0) {
+        m_value = slot.value;
+        return m_value != TstNode::s_invalid;
+    }
+
+    if (slot.root != NULL)
+        m_stack.push_back(Frame{slot.root, 2, s_left});
+    return false;
+}
+
+inline void TstCursor::first() {
+    seek(std::string());
+}
+
+inline void TstCursor::seek(const std::string &lower_bound) {
+    m_valid = false;
+
+    if (lower_bound.empty()) {
+        m_source = 0;
+        m_valid  = open(m_source);
+        if (!m_valid)
+            advance();
+        return;
+    }
+
+    if (m_tst.m_table.empty()) {
+        m_source = 1;
+        m_stack.clear();
+        m_key.clear();
+        seek_stack(m_tst.m_root, lower_bound, 0);
+        advance();
+        return;
+    }
+
+    /* Sources before the one of lower bound contain smaller keys */
+    std::size_t c0 = (unsigned char)lower_bound[0];
+    if (lower_bound.size() == 1) {
+        m_source = 1 + c0 * s_per_char;
+    } else {
+        std::size_t c1 = (unsigned char)lower_bound[1];
+        m_source = 1 + c0 * s_per_char + 1 + 2 * c1;
+        if (lower_bound.size() > 2)
+            ++m_source;
+    }
+
+    m_valid = open(m_source);
+    if (lower_bound.size() > 2) {
+        std::size_t depth = 2;
+        const TstNode *root = m_stack.empty() ? NULL : m_stack.back().node;
+        m_stack.clear();
+        seek_stack(root, lower_bound, depth);
+    }
+
+    if (!m_valid)
+        advance();
+}
+
+inline void TstCursor::seek_stack(const TstNode *node,
+        const std::string &lower_bound, std::size_t depth) {
+
+    while (node != NULL) {
+        unsigned char c = lower_bound[depth];
+        if (c < node->m_letter) {
+
+            /* Node and everything after it is greater */
+            m_stack.push_back(Frame{node, depth, s_self});
+            node = node->m_lnode;
+        } else if (c > node->m_letter) {
+
+            /* Node and its left BST and middle link are smaller */
+            node = node->m_rnode;
+        } else if (depth + 1 < lower_bound.size()) {
+
+            /* Key of node is a proper prefix of lower bound */
+            m_stack.push_back(Frame{node, depth, s_right});
+            m_key.resize(depth);
+            m_key.push_back(static_cast<char>(c));
+            node = node->m_nnode;
+            ++depth;
+        } else {
+            m_stack.push_back(Frame{node, depth, s_self});
+            return;
+        }
+    }
+}
+
+inline void TstCursor::next() {
+    advance();
+}
+
+inline void TstCursor::advance() {
+    for (;;) {
+        if (advance_stack()) {
+            m_valid = true;
+            return;
+        }
+
+        if (++m_source >= sources()) {
+            m_valid = false;
+            return;
+        }
+
+        if (open(m_source)) {
+            m_valid = true;
+            return;
+        }
+    }
+}
+
+inline bool TstCursor::advance_stack() {
+    while (!m_stack.empty()) {
+        Frame &frame = m_stack.back();
+        const TstNode *node = frame.node;
+        std::size_t depth = frame.depth;
+
+        switch (frame.state) {
+        case s_left:
+            frame.state = s_self;
+            if (node->m_lnode != NULL)
+                m_stack.push_back(Frame{node->m_lnode, depth, s_left});
+            break;
+
+        case s_self:
+            frame.state = s_middle;
+            if (node->m_value != TstNode::s_invalid) {
+                m_key.resize(depth);
+                m_key.push_back(static_cast<char>(node->m_letter));
+                m_value = node->m_value;
+                return true;
+            }
+            break;
+
+        case s_middle:
+            frame.state = s_right;
+            if (node->m_nnode != NULL) {
+                m_key.resize(depth);
+                m_key.push_back(static_cast<char>(node->m_letter));
+                m_stack.push_back(Frame{node->m_nnode, depth + 1, s_left});
+            }
+            break;
+
+        default:
+            m_stack.pop_back();
+            if (node->m_rnode != NULL)
+                m_stack.push_back(Frame{node->m_rnode, depth, s_left});
+            break;
+        }
+    }
+
+    return false;
+}
+
+inline bool TstCursor::valid() const {
+    return m_valid;
+}
+
+inline const std::string &TstCursor::key() const {
+    return m_key;
+}
+
+inline int TstCursor::value() const {
+    return m_value;
+}
+
+template <typename F>
+void Tst::range(const std::string &lo, const std::string &hi,
+        F func) const {
+    TstCursor cursor(*this);
+    for (cursor.seek(lo); cursor.valid() && cursor.key() < hi;
+            cursor.next())
+        func(cursor.key(), cursor.value());
+}
+
+#endif  /* _TRIES_TST_TST_H */
@@ -2,19 +2,36 @@
 /*
  * Geiger counter for network interface activity. This tool 'clicks'
  * each time new ip package available on specified network interface. 
+ * Capture and playback run in separate threads: capture only queues
+ * timestamps of packages, audio thread mixes clicks into a long-lived
+ * alsa stream. At high package rates clicks are thinned like in a
+ * real counter with dead time, so the tool stays listenable and its
+ * load doesn't grow with traffic.
  * Be careful this tool produces nasty sound and it's very anoying.
  * First time I found mention of such kind of tool in 'Expert C
  * Programming' by Peter Van Der Linden. And I decided to implement 
  * it for educational purposes.
  */
+#include <math.h>
+#include <time.h>
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/time.h>
 #include <pcap/pcap.h>
 #include <alsa/asoundlib.h>
 
+/* Size of click queue, must be a power of 2 */
+#define RING_SIZE 1024
+
+/* Maximum amount of clicks played at the same time */
+#define VOICES 32
+
 /* Global state of playback device and signal buffer.
  * g_phandle  - handle for alsa playback device
  * g_signal   - geiger counter signal buffer
@@ -22,13 +39,58 @@
  * g_rate     - sampling rate (in hz)
  * g_channels - amount of channels
  * g_bps      - amount of bits per sample
+ * g_period   - amount of frames in alsa period
+ */
+snd_pcm_t        *g_phandle;
+short            *g_signal;
+int               g_size;
+int               g_rate     = 44100;
+short             g_channels = 2;
+short             g_bps      = 16;
+snd_pcm_uframes_t g_period   = 256;
+
+/* Single producer single consumer queue of click timestamps. Capture
+ * thread is the only writer of g_head, audio thread is the only writer
+ * of g_tail, so neither of them ever waits for the other one.
+ * g_ring - timestamps of captured packages
+ * g_head - amount of timestamps pushed to the queue
+ * g_tail - amount of timestamps popped from the queue
  */
-snd_pcm_t *g_phandle;
-short     *g_signal;
-int        g_size;
-int        g_rate     = 44100;
-short      g_channels = 2;
-short      g_bps      = 16;
+struct timeval g_ring[RING_SIZE];
+atomic_uint    g_head;
+atomic_uint    g_tail;
+
+/* Rate estimation and click thinning state, used by capture thread
+ * only. Rate is an exponentially weighted moving average: every
+ * package adds 1 / g_window to it, and it decays by exp(-t / g_window)
+ * over time t. Package clicks with probability 1 / (1 + r * g_dead_time)
+ * for rate r, so clicks rate is r / (1 + r * g_dead_time) and never
+ * exceeds 1 / g_dead_time, as for a counter with non-paralyzable dead
+ * time.
+ * g_window    - averaging window of rate estimation (in seconds)
+ * g_dead_time - dead time of the counter (in seconds)
+ * g_pps       - estimated packages rate before current batch (per second)
+ * g_last      - time of the last rate decay (in seconds)
+ * g_batch     - amount of packages in current batch
+ * g_random    - state of random generator
+ */
+double   g_window    = 0.5;
+double   g_dead_time = 0.002;
+double   g_pps;
+double   g_last;
+int      g_batch;
+uint32_t g_random    = 2463534242u;
+
+/* Global state of audio thread.
+ * g_audio   - audio thread
+ * g_running - audio thread runs while it's set
+ * g_mix     - mixing buffer of one period
+ * g_buffer  - samples of one period written to alsa device
+ */
+pthread_t      g_audio;
+atomic_int     g_running;
+int           *g_mix;
+short         *g_buffer;
 
 /* Allocate memory for geiger counter signal, read signal from file
  * specified in arguments. It's expected that specified file is .wav
@@ -173,9 +235,14 @@ void signal_free(short *sig) {
 
 /* Open and tune alsa snd pcm handle. This function sets appropriate
  * sampling frequency, sample format and amount of channels for
- * handle. In case of success 0 is returned, otherwise 1 is returned. 
+ * handle. Period of a few milliseconds and buffer of a few periods
+ * keep latency of clicks low. In case of success 0 is returned,
+ * otherwise 1 is returned. 
+ *
+ * handle - alsa device handle
+ * period - requested amount of frames in period, set to the real one
  */
-int asound_alloc(snd_pcm_t **handle) {
+int asound_alloc(snd_pcm_t **handle, snd_pcm_uframes_t *period) {
     int err;
     err = snd_pcm_open(handle, "hw:1,0", SND_PCM_STREAM_PLAYBACK, 0);
     if (err < 0) {
@@ -240,6 +307,25 @@ int asound_alloc(snd_pcm_t **handle) {
         return 1;
     }
 
+    /* Set period size */
+    if ((err = snd_pcm_hw_params_set_period_size_near(*handle, hw_params,
+           period, &dir)) < 0) {
+        fprintf(stderr, "%s: snd_pcm_hw_params_set_period_size_near error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+        snd_pcm_close(*handle);
+        return 1;
+    }
+
+    /* Set buffer size to 4 periods */
+    snd_pcm_uframes_t buffer = *period * 4;
+    if ((err = snd_pcm_hw_params_set_buffer_size_near(*handle, hw_params,
+           &buffer)) < 0) {
+        fprintf(stderr, "%s: snd_pcm_hw_params_set_buffer_size_near error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+        snd_pcm_close(*handle);
+        return 1;
+    }
+
     /* Apply hardware parameters */
     if ((err = snd_pcm_hw_params(*handle, hw_params)) < 0) {
         fprintf(stderr, "%s: snd_pcm_hw_params error\n", __func__);
@@ -248,6 +334,15 @@ int asound_alloc(snd_pcm_t **handle) {
         return 1;
     }
 
+    /* Period size may be adjusted by the device */
+    if ((err = snd_pcm_hw_params_get_period_size(hw_params, period,
+           &dir)) < 0) {
+        fprintf(stderr, "%s: snd_pcm_hw_params_get_period_size error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+        snd_pcm_close(*handle);
+        return 1;
+    }
+
     snd_pcm_hw_params_free(hw_params);
 
     if ((err = snd_pcm_prepare(*handle)) < 0) {
@@ -265,70 +360,237 @@ void asound_free(snd_pcm_t *handle) {
     snd_pcm_close(handle);
 }
 
-/* Play signal of length (len) from buffer in arguments (signal) using
- * alsa device handle (handle). In case of error 1 is returned
+/* Write samples of length (len) from buffer in arguments (signal)
+ * to alsa device handle (handle). Write blocks while device ring
+ * buffer is full, which paces the audio thread. Underrun is
+ * recovered and writing continues. In case of error 1 is returned
  * otherwise 0 is returned.
  *
  * handle - alsa device handle
  * signal - playback signal buffer
  * len    - amount of samples per channel in signal buffer
- *
  */
-int asound_play(snd_pcm_t *handle, const short *signal, int len) {
-    int err;
-    
-    /* Prepare alsa device for playback */
-    if ((err = snd_pcm_prepare(handle)) < 0) {
-        fprintf(stderr, "%s: snd_pcm_prepare error\n", __func__);
-        fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+int asound_write(snd_pcm_t *handle, const short *signal, int len) {
+    while (len > 0) {
+        snd_pcm_sframes_t err = snd_pcm_writei(handle, signal, len);
+        if (err < 0) {
+            if ((err = snd_pcm_recover(handle, err, 1)) < 0) {
+                fprintf(stderr, "%s: snd_pcm_writei error\n", __func__);
+                fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+                return 1;
+            }
+            continue;
+        }
+
+        signal += err * g_channels;
+        len -= err;
+    }
+
+    return 0;
+}
+
+/* Push timestamp (ts) to click queue. It's called from capture thread
+ * only. In case queue is full click is dropped and 1 is returned,
+ * otherwise 0 is returned.
+ */
+int ring_push(const struct timeval *ts) {
+    unsigned head = atomic_load_explicit(&g_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&g_tail, memory_order_acquire);
+    if (head - tail == RING_SIZE) {
         return 1;
     }
 
-    /* Write signal to ring buffer */
-    if ((err = snd_pcm_writei(handle, signal, len)) < 0) {
-        fprintf(stderr, "%s: snd_pcm_writei error\n", __func__);
-        fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+    g_ring[head & (RING_SIZE - 1)] = *ts;
+    atomic_store_explicit(&g_head, head + 1, memory_order_release);
+    return 0;
+}
+
+/* Pop timestamp from click queue to (ts). It's called from audio
+ * thread only. In case queue is empty 1 is returned, otherwise 0 is
+ * returned.
+ */
+int ring_pop(struct timeval *ts) {
+    unsigned tail = atomic_load_explicit(&g_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&g_head, memory_order_acquire);
+    if (head == tail) {
         return 1;
     }
 
-    /* Set state for waiting next portion of data */
-    if ((err = snd_pcm_drain(handle)) < 0) {
-        fprintf(stderr, "%s: snd_pcm_drain error\n", __func__);
-        fprintf(stderr, "%s: %s\n", __func__, snd_strerror(err));
+    *ts = g_ring[tail & (RING_SIZE - 1)];
+    atomic_store_explicit(&g_tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+/* Audio thread routine. Every iteration pops queued clicks, mixes all
+ * playing clicks into one period and writes it to alsa device, silent
+ * periods included, so the stream never stops. Clicks keep spacing of
+ * their capture timestamps: the first click is played at the start of
+ * the next period and defines mapping of capture time to stream
+ * frames, following clicks are delayed according to it. Mapping is
+ * reset when a click falls behind the stream or too far ahead of it.
+ */
+void *audio_loop(void *arg) {
+    long long period = g_period;
+    long long len = g_size / (g_bps / 8) / g_channels;
+
+    /* Position of the next frame of every playing click in signal
+     * buffer. Negative position delays start of the click.
+     */
+    long long pos[VOICES];
+    int voices = 0;
+
+    /* Capture time (in us) of stream frame 0, amount of frames
+     * written since it and whether the mapping is set at all.
+     */
+    long long origin = 0;
+    long long frame = 0;
+    int synced = 0;
+
+    while (atomic_load(&g_running)) {
+        struct timeval ts;
+        while (ring_pop(&ts) == 0) {
+            long long usec = ts.tv_sec * 1000000LL + ts.tv_usec;
+            long long at = 0;
+            if (synced) {
+                at = (usec - origin) * g_rate / 1000000 - frame;
+            }
+            if (!synced || at < 0 || at >= 4 * period) {
+                origin = usec - frame * 1000000 / g_rate;
+                synced = 1;
+                at = 0;
+            }
+            if (voices < VOICES) {
+                pos[voices++] = -at;
+            }
+        }
+
+        /* Mix playing clicks */
+        memset(g_mix, 0, period * g_channels * sizeof(*g_mix));
+        for (int i = 0; i < voices; ) {
+            long long f = pos[i] < 0 ? -pos[i] : 0;
+            for (; f < period && pos[i] + f < len; ++f) {
+                for (int c = 0; c < g_channels; ++c) {
+                    g_mix[f * g_channels + c] +=
+                        g_signal[(pos[i] + f) * g_channels + c];
+                }
+            }
+
+            pos[i] += period;
+            if (pos[i] >= len) {
+                pos[i] = pos[--voices];
+            } else {
+                ++i;
+            }
+        }
+
+        /* Saturate mixed samples */
+        for (long long k = 0; k < period * g_channels; ++k) {
+            int sample = g_mix[k];
+            sample = sample > 32767 ? 32767 : sample;
+            sample = sample < -32768 ? -32768 : sample;
+            g_buffer[k] = sample;
+        }
+
+        if (asound_write(g_phandle, g_buffer, period) != 0) {
+            break;
+        }
+        frame += period;
+    }
+
+    return NULL;
+}
+
+/* Open alsa device and start audio thread. In case of success 0 is
+ * returned, otherwise 1 is returned.
+ */
+int audio_start(void) {
+    if (asound_alloc(&g_phandle, &g_period) != 0) {
         return 1;
     }
-    
+
+    g_mix = (int *)malloc(g_period * g_channels * sizeof(*g_mix));
+    g_buffer = (short *)malloc(g_period * g_channels * sizeof(*g_buffer));
+    if (g_mix == NULL || g_buffer == NULL) {
+        fprintf(stderr, "%s: malloc error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        free(g_mix);
+        free(g_buffer);
+        asound_free(g_phandle);
+        return 1;
+    }
+
+    atomic_store(&g_running, 1);
+    int err = pthread_create(&g_audio, NULL, audio_loop, NULL);
+    if (err != 0) {
+        fprintf(stderr, "%s: pthread_create error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(err));
+        free(g_mix);
+        free(g_buffer);
+        asound_free(g_phandle);
+        return 1;
+    }
+
     return 0;
 }
 
+/* Stop audio thread and free resources of alsa device */
+void audio_stop(void) {
+    atomic_store(&g_running, 0);
+    pthread_join(g_audio, NULL);
+    free(g_mix);
+    free(g_buffer);
+    asound_free(g_phandle);
+}
+
+/* Get next value of xorshift random generator */
+uint32_t random_next(void) {
+    g_random ^= g_random << 13;
+    g_random ^= g_random >> 17;
+    g_random ^= g_random << 5;
+    return g_random;
+}
+
+/* Get current time of monotonic clock (in seconds) */
+double clock_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 /* Package handler defenition. This function is repeatedly called
- * from insides of pcap_loop function when next ip package is
- * arriving. It plays 'click' sound by allocating new alsa device
- * handle, writing 'click' signal to alsa ring buffer and deallocating
- * device handler.
+ * from insides of pcap_dispatch function for every ip package of the
+ * batch. The first package of the batch decays rate estimation over
+ * time since the previous batch. Packages of the current batch are
+ * added to rate estimation right away, so thinning reacts to a burst
+ * within its first batch.
+ * Kept package only queues its timestamp for audio thread, so capture
+ * never waits for playback. Work per package is constant.
  *
- * user   - user argument of pcap_loop call
+ * user   - user argument of pcap_dispatch call
  * pkghdr - data structure with information about package
  * bytes  - size of captured package portion
  */
 void phandler(u_char *user, const struct pcap_pkthdr *pkghdr,
         const u_char *bytes) {
-    if (asound_alloc(&g_phandle) != 0) {
-        return;
+    if (++g_batch == 1) {
+        double now = clock_now();
+        g_pps *= exp(-(now - g_last) / g_window);
+        g_last = now;
     }
 
-    /* Compute amount of samples in signal per channel */
-    int len = g_size / (g_bps / 8) / g_channels;
-    asound_play(g_phandle, g_signal, len);
-    asound_free(g_phandle);
+    double pps = g_pps + g_batch / g_window;
+    double keep = 1.0 / (1.0 + pps * g_dead_time);
+    if (random_next() * (1.0 / 4294967296.0) < keep) {
+        ring_push(&pkghdr->ts);
+    }
 }
 
 /* Attach monitoring loop to network interface in arguments
  * (iface). In current implementation of the tool this procedure never
- * returns in case of success. In case of success it calls pcap_loop
- * function that perform monitoring of network interface and calls
- * appropriate handle each time new ip package arives. In case of
- * error 1 is returned.
+ * returns in case of success. In case of success it repeatedly calls
+ * pcap_dispatch function that handles a batch of packages available
+ * on network interface, and adds packages of every batch to rate
+ * estimation. In case of error 1 is returned.
  *
  * iface - network interface name
  */
@@ -360,6 +622,13 @@ int attach_to_interface(const char *iface) {
         return 1;
     }
 
+    /* Deliver batches at least every 10 ms */
+    if (pcap_set_timeout(handle, 10) != 0) {
+        fprintf(stderr, "%s: pcap_set_timeout error\n", __func__);
+        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
+        return 1;
+    }
+
     if (pcap_activate(handle) != 0) {
         fprintf(stderr, "%s: pcap_activate error\n", __func__);
         fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
@@ -367,10 +636,18 @@ int attach_to_interface(const char *iface) {
     }
 
     u_char user[] = "geiger_counter";
-    if (pcap_loop(handle, 0, phandler, user) != 0) {
-        fprintf(stderr, "%s: pcap_loop error\n", __func__);
-        fprintf(stderr, "%s: %s\n", __func__, strerror(errno));
-        return 1;
+    g_random ^= (uint32_t)time(NULL);
+    g_last = clock_now();
+    for (;;) {
+        g_batch = 0;
+        if (pcap_dispatch(handle, -1, phandler, user) < 0) {
+            fprintf(stderr, "%s: pcap_dispatch error\n", __func__);
+            fprintf(stderr, "%s: %s\n", __func__, pcap_geterr(handle));
+            pcap_close(handle);
+            return 1;
+        }
+
+        g_pps += g_batch / g_window;
     }
 
     /* This block of code actually never called */
@@ -415,8 +692,16 @@ int main(int argc, char *argv[]) {
     while ((opt = getopt(argc, argv, "i:lh")) != -1) {
         switch (opt) {
         case 'i':
-            signal_alloc("geiger.wav", &g_signal, &g_size);
+            if (signal_alloc("geiger.wav", &g_signal, &g_size) != 0) {
+                return 1;
+            }
+            if (audio_start() != 0) {
+                signal_free(g_signal);
+                return 1;
+            }
             attach_to_interface(optarg);
+            audio_stop();
+            signal_free(g_signal);
             return 0;
         case 'l':
             print_available_interfaces();